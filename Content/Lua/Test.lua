@@ -3,6 +3,8 @@ require 'TestProfile'
 
 --- step gc 1ms in one frame, limit of 1000 times. Just do one gc cycle in 60 seconds.
 slua.setGCParam(0.001, 1000, 60)
+--- or use adaptive pacer, 1ms budget in 30fps frame, keep heap under 64MB, check slua.getGCStats()
+-- slua.setGCPacer(0.001, 64 * 1024, 1 / 30)
 
 -- some.field come from c++
 some.field.y = 103
@@ -48,6 +48,24 @@ arr:Add(1)
 arr:Add(2)
 arr:Add(3)
 assert(arr:Num()==3)
+assert(arr[0]==1 and arr[2]==3 and arr[3]==nil)
+arr[1]=5
+assert(arr:Get(1)==5)
+local values = arr:ToTable()
+assert(#values==3 and values[1]==1 and values[2]==5)
+assert(arr:FromTable({7,8})==2)
+assert(arr:Num()==2 and arr[1]==8)
+
+-- typed view over TArray<int>
+local v = slua.view(arr, "i32")
+assert(#v==2 and v[0]==7 and v:Sum()==15 and v:Min()==7 and v:Max()==8)
+v[0]=1
+assert(arr:Get(0)==1)
+v:Map("mul", 3)
+assert(arr[0]==3 and arr[1]==24)
+arr:Add(5)
+v:Fill(2, 1)
+assert(v:Num()==3 and v:Sum()==7)
 
 -- create TArray<FString>
 local arr = slua.Array(EPropertyClass.Str)
@@ -4,6 +4,8 @@ local SluaTestCase=import('SluaTestCase');
 local t=SluaTestCase();
 
 local TestCount = 1000000
+-- calls below use static binding in SluaTestCaseBinding.cpp,
+-- run again after 'slua.StaticBinding 0' for shape thunks, then 'slua.CallShapeThunk 0' to compare
 local start = os.clock()
 for i=1,TestCount do
     t:EmptyFunc(t)
@@ -28,6 +30,26 @@ for i=1,TestCount do
 end
 print("1m call FuncWithStr, take time",os.clock()-start)
 
+local start = os.clock()
+for i=1,TestCount do
+    t.Value = t.Value + 1
+end
+print("1m get and set Value, take time",os.clock()-start)
+
+-- plain params of native function, compare 'slua.DirectNativeCall 0'
+local a, b = FVector(1, 2, 3), FVector(4, 5, 6)
+local start = os.clock()
+for i=1,TestCount do
+    t:AddVector(a, b)
+end
+print("1m call AddVector, take time",os.clock()-start)
+
+-- lua function called by UFunction params, same path as overridden event
+t.OnTestGetCount:Bind(function(s) return 1 end)
+local start = os.clock()
+t:TestUnicastDelegateLoop("tick", TestCount)
+print("1m execute lua delegate, take time",os.clock()-start)
+
 -- cppbinding performance test
 local t=PerfTest(0)
 local start = os.clock()
@@ -52,4 +74,175 @@ local start = os.clock()
 for i=1,TestCount do
     t:FuncWithStr("hello world")
 end
-print("1m call FuncWithStr(cppbinding), take time",os.clock()-start)
\ No newline at end of file
+print("1m call FuncWithStr(cppbinding), take time",os.clock()-start)
+
+-- LuaVar holding int, string and function
+local f = function(n, s) return n end
+print("1m LuaVar construct/copy/destroy, take time",t:LuaVarLoop(f, TestCount, false))
+print("1m LuaVar call, take time",t:LuaVarLoop(f, TestCount, true))
+print("1m LuaVar::call(int,float), take time",t:LuaVarCall(function(i, f) end, TestCount))
+
+-- table churn, compare slua.SizeClassAlloc 0/1 and check slua.DumpAllocStats
+local start = os.clock()
+for i=1,TestCount do
+    local t = {i, x=i, y="churn"}
+    t.z = {i}
+end
+print("1m table churn, take time",os.clock()-start)
+
+local start = os.clock()
+for i=1,TestCount do
+    local s = "churn" .. i
+end
+print("1m string churn, take time",os.clock()-start)
+
+-- property access, compare slua.AccessorTable 0/1
+local t=SluaTestCase();
+-- property loops below hit inline cache, run again after 'slua.InlineCache 0' to compare
+local start = os.clock()
+local v = 0
+for i=1,TestCount do
+    v = v + t.Value
+end
+print("1m get property, take time",os.clock()-start)
+
+local start = os.clock()
+for i=1,TestCount do
+    t.Value = i
+end
+print("1m set property, take time",os.clock()-start)
+
+local info = t.info
+local start = os.clock()
+for i=1,TestCount do
+    info.level = info.id
+end
+print("1m get/set struct property, take time",os.clock()-start)
+
+local fields = slua.fieldList(info, {"id", "level"})
+local values = {}
+local start = os.clock()
+for i=1,TestCount do
+    slua.getProps(info, fields, values)
+    values.level = values.id
+    slua.setProps(info, values, fields)
+end
+print("1m get/set struct property by field list, take time",os.clock()-start)
+
+-- names that aren't properties go to __index/__newindex, e.g. UFunction
+local mixed = slua.getProps(t, slua.fieldList(t, {"Value", "GetArray"}))
+assert(mixed.Value == t.Value and type(mixed.GetArray) == "function")
+assert(not pcall(slua.fieldList, t, {1}))
+
+-- run with 'slua.InlineValueType 0/1' to compare allocations
+local function vectorMath(inPlace)
+    local stats = slua.getValueTypeStats()
+    local heap, inlined = stats.heap, stats.inlined
+    local mem = collectgarbage("count")
+    local pos = FVector(0, 0, 0)
+    local vel = FVector(1, 2, 3)
+    local start = os.clock()
+    for i=1,TestCount do
+        if inPlace then
+            pos:AddInPlace(vel)
+        else
+            pos = pos + vel
+        end
+    end
+    stats = slua.getValueTypeStats()
+    print(inPlace and "1m vector add in place" or "1m vector add", "take time", os.clock()-start,
+        "heap", stats.heap-heap, "inlined", stats.inlined-inlined, "lua kb", collectgarbage("count")-mem)
+end
+vectorMath(false)
+vectorMath(true)
+
+-- in-place methods return self for chaining
+local rot = FRotator(0, 0, 0)
+assert(rot:Set(1, 2, 3):AddInPlace(FRotator(1, 1, 1)) == rot)
+assert(rot.Pitch == 2 and rot.Yaw == 3 and rot.Roll == 4)
+
+-- first push of new objects and full gc, run on new state after 'slua.NativeObjectCache 0' to compare
+local objs = {}
+local start = os.clock()
+for i=1,10000 do
+    objs[i] = SluaTestCase()
+end
+print("10k new object push, take time",os.clock()-start)
+objs = nil
+local start = os.clock()
+collectgarbage("collect")
+local stats = slua.getGCStats()
+print("full gc after 10k objects, take time",os.clock()-start,"object cache hits",stats.objCacheHits,"live",stats.objCacheLive)
+
+-- iterate 100k elements of TArray<int32> and TArray<FVector>
+local function arrayIteration(arr, name)
+    local n = arr:Num()
+    local start = os.clock()
+    for i=0,n-1 do
+        local v = arr:Get(i)
+    end
+    print("100k "..name.." array Get, take time",os.clock()-start)
+
+    local start = os.clock()
+    for i=0,n-1 do
+        local v = arr[i]
+    end
+    print("100k "..name.." array index, take time",os.clock()-start)
+
+    local start = os.clock()
+    for i,v in pairs(arr) do
+    end
+    print("100k "..name.." array pairs, take time",os.clock()-start)
+
+    local start = os.clock()
+    local values = arr:ToTable()
+    for i=1,#values do
+        local v = values[i]
+    end
+    print("100k "..name.." array ToTable, take time",os.clock()-start)
+end
+
+local values = {}
+for i=1,100000 do
+    values[i] = i
+end
+local ints = slua.Array(EPropertyClass.Int)
+local start = os.clock()
+ints:FromTable(values)
+print("100k int32 array FromTable, take time",os.clock()-start)
+arrayIteration(ints, "int32")
+
+for i=1,100000 do
+    values[i] = FVector(i, i, i)
+end
+local vectors = slua.Array(EPropertyClass.Struct, import("Vector"))
+local start = os.clock()
+vectors:FromTable(values)
+print("100k FVector array FromTable, take time",os.clock()-start)
+arrayIteration(vectors, "FVector")
+
+-- sum of 100k floats, by Get and by typed view
+local floats = slua.Array(EPropertyClass.Float)
+for i=1,100000 do
+    values[i] = i * 0.5
+end
+floats:FromTable(values)
+local start = os.clock()
+local sum = 0
+for i=0,floats:Num()-1 do
+    sum = sum + floats:Get(i)
+end
+print("100k float array sum by Get, take time",os.clock()-start)
+
+local view = slua.view(floats, "f32")
+local start = os.clock()
+sum = 0
+for i=0,#view-1 do
+    sum = sum + view[i]
+end
+print("100k float view sum by index, take time",os.clock()-start)
+
+local start = os.clock()
+sum = view:Sum()
+view:Map("mul", 2)
+print("100k float view Sum and Map, take time",os.clock()-start)
@@ -1180,6 +1180,36 @@ LUA_API void lua_setallocf (lua_State *L, lua_Alloc f, void *ud) {
 }
 
 
+#if defined(LUA_INLINE_CACHE)
+LUA_API void lua_setinlinecache (lua_State *L, lua_ICacheResolve resolve,
+                                 lua_ICacheGet get, lua_ICacheSet set) {
+  global_State *g = G(L);
+  lua_lock(L);
+  g->icacheresolve = resolve;
+  g->icacheget = get;
+  g->icacheset = set;
+  g->icacheepoch++;
+  lua_unlock(L);
+}
+
+
+LUA_API void lua_resetinlinecache (lua_State *L) {
+  lua_lock(L);
+  G(L)->icacheepoch++;
+  lua_unlock(L);
+}
+#endif
+
+
+#if defined(LUA_FNZ_HOOK)
+LUA_API void lua_setfnzhook (lua_State *L, lua_FnzHook f) {
+  lua_lock(L);
+  G(L)->fnzhook = f;
+  lua_unlock(L);
+}
+#endif
+
+
 LUA_API void *lua_newuserdata (lua_State *L, size_t size) {
   Udata *u;
   lua_lock(L);
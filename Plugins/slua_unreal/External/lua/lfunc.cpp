@@ -116,6 +116,10 @@ Proto *luaF_newproto (lua_State *L) {
   f->linedefined = 0;
   f->lastlinedefined = 0;
   f->source = NULL;
+#if defined(LUA_INLINE_CACHE)
+  f->icache = NULL;
+  f->sizeicache = 0;
+#endif
   return f;
 }
 
@@ -127,6 +131,9 @@ void luaF_freeproto (lua_State *L, Proto *f) {
   luaM_freearray(L, f->lineinfo, f->sizelineinfo);
   luaM_freearray(L, f->locvars, f->sizelocvars);
   luaM_freearray(L, f->upvalues, f->sizeupvalues);
+#if defined(LUA_INLINE_CACHE)
+  luaM_freearray(L, f->icache, f->sizeicache);
+#endif
   luaM_free(L, f);
 }
 
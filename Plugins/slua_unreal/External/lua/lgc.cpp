@@ -703,7 +703,14 @@ static void freeobj (lua_State *L, GCObject *o) {
       luaM_freemem(L, o, sizeCclosure(gco2ccl(o)->nupvalues));
       break;
     }
-    case LUA_TTABLE: luaH_free(L, gco2t(o)); break;
+    case LUA_TTABLE: {
+#if defined(LUA_INLINE_CACHE)
+      /* address may be reused by another metatable, drop cached sites */
+      if (gco2t(o)->icached) G(L)->icacheepoch++;
+#endif
+      luaH_free(L, gco2t(o));
+      break;
+    }
     case LUA_TTHREAD: luaE_freethread(L, gco2th(o)); break;
     case LUA_TUSERDATA: luaM_freemem(L, o, sizeudata(gco2u(o))); break;
     case LUA_TSHRSTR:
@@ -884,6 +891,13 @@ static void separatetobefnz (global_State *g, int all) {
     if (!(iswhite(curr) || all))  /* not being collected? */
       p = &curr->next;  /* don't bother with it */
     else {
+#if defined(LUA_FNZ_HOOK)
+      if (g->fnzhook && curr->tt == LUA_TUSERDATA) {
+        const TValue *tm = gfasttm(g, gco2u(curr)->metatable, TM_GC);
+        if (tm != NULL && ttislcf(tm))
+          g->fnzhook(g->mainthread, getudatamem(gco2u(curr)), fvalue(tm));
+      }
+#endif
       *p = curr->next;  /* remove 'curr' from 'finobj' list */
       curr->next = *lastnext;  /* link at the end of 'tobefnz' list */
       *lastnext = curr;
@@ -400,6 +400,21 @@ typedef struct LocVar {
 } LocVar;
 
 
+#if defined(LUA_INLINE_CACHE)
+/*
+** Cache of a field access site on full userdata, valid while the
+** userdata has metatable 'mt' and global epoch is unchanged
+*/
+typedef struct ICacheEntry {
+  struct Table *mt;  /* freeing it bumps global epoch, see 'icached' */
+  void *data;  /* data returned by resolver, NULL if not cacheable */
+  int pc;  /* instruction index of the site */
+  unsigned int epoch;
+  int misses;  /* site is megamorphic when it reaches MAXICACHEMISS */
+} ICacheEntry;
+#endif
+
+
 /*
 ** Function Prototypes
 */
@@ -425,6 +440,10 @@ typedef struct Proto {
   struct LClosure *cache;  /* last-created closure with this prototype */
   TString  *source;  /* used for debug information */
   GCObject *gclist;
+#if defined(LUA_INLINE_CACHE)
+  ICacheEntry *icache;  /* direct mapped by pc, created on first use */
+  int sizeicache;
+#endif
 } Proto;
 
 
@@ -497,6 +516,9 @@ typedef struct Table {
   CommonHeader;
   lu_byte flags;  /* 1<<p means tagmethod(p) is not present */
   lu_byte lsizenode;  /* log2 of size of 'node' array */
+#if defined(LUA_INLINE_CACHE)
+  lu_byte icached;  /* used as metatable by inline cache entries */
+#endif
   unsigned int sizearray;  /* size of 'array' array */
   TValue *array;  /* array part */
   Node *node;
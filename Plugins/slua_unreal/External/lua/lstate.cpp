@@ -331,6 +331,15 @@ LUA_API lua_State *lua_newstate (lua_Alloc f, void *ud) {
   g->gcpause = LUAI_GCPAUSE;
   g->gcstepmul = LUAI_GCMUL;
   for (i=0; i < LUA_NUMTAGS; i++) g->mt[i] = NULL;
+#if defined(LUA_INLINE_CACHE)
+  g->icacheresolve = NULL;
+  g->icacheget = NULL;
+  g->icacheset = NULL;
+  g->icacheepoch = 0;
+#endif
+#if defined(LUA_FNZ_HOOK)
+  g->fnzhook = NULL;
+#endif
   if (luaD_rawrunprotected(L, f_luaopen, NULL) != LUA_OK) {
     /* memory allocation error: free partial state */
     close_state(L);
@@ -148,6 +148,15 @@ typedef struct global_State {
   TString *tmname[TM_N];  /* array with tag-method names */
   struct Table *mt[LUA_NUMTAGS];  /* metatables for basic types */
   TString *strcache[STRCACHE_N][STRCACHE_M];  /* cache for strings in API */
+#if defined(LUA_INLINE_CACHE)
+  lua_ICacheResolve icacheresolve;
+  lua_ICacheGet icacheget;  /* NULL if inline cache disabled */
+  lua_ICacheSet icacheset;
+  unsigned int icacheepoch;  /* bumped to invalidate all cached sites */
+#endif
+#if defined(LUA_FNZ_HOOK)
+  lua_FnzHook fnzhook;
+#endif
 } global_State;
 
 
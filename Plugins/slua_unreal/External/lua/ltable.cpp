@@ -403,6 +403,9 @@ Table *luaH_new (lua_State *L) {
   Table *t = gco2t(o);
   t->metatable = NULL;
   t->flags = cast_byte(~0);
+#if defined(LUA_INLINE_CACHE)
+  t->icached = 0;
+#endif
   t->array = NULL;
   t->sizearray = 0;
   setnodevector(L, t, 0);
@@ -329,6 +329,37 @@ LUA_API size_t   (lua_stringtonumber) (lua_State *L, const char *s);
 LUA_API lua_Alloc (lua_getallocf) (lua_State *L, void **ud);
 LUA_API void      (lua_setallocf) (lua_State *L, lua_Alloc f, void *ud);
 
+#if defined(LUA_INLINE_CACHE)
+/*
+** inline cache of 'u.k' and 'u.k = v' with constant string key on full
+** userdata. 'resolve' gets the userdata at 'uidx' and key at 'kidx',
+** returns 0 if the instance can't decide, else stores data shared by all
+** userdata with same metatable (NULL to skip the site) to '*data'.
+** 'get' pushes the value and returns 1, 'set' assigns value at 'vidx' and
+** returns 1; both return 0 to fall back to metamethods. A site failing
+** with several metatables is left to metamethods until epoch changes.
+*/
+typedef int (*lua_ICacheResolve) (lua_State *L, int uidx, int kidx, int isset, void **data);
+typedef int (*lua_ICacheGet) (lua_State *L, void *u, void *data);
+typedef int (*lua_ICacheSet) (lua_State *L, void *u, void *data, int vidx);
+
+LUA_API void (lua_setinlinecache) (lua_State *L, lua_ICacheResolve resolve,
+                                   lua_ICacheGet get, lua_ICacheSet set);
+/* drop all cached sites, call it when data returned by resolver changed */
+LUA_API void (lua_resetinlinecache) (lua_State *L);
+#endif
+
+#if defined(LUA_FNZ_HOOK)
+/*
+** called when unreachable userdata 'u' whose __gc is light C function
+** 'gc' is moved to the list to be finalized, before weak tables are
+** cleared. it must not call any lua API
+*/
+typedef void (*lua_FnzHook) (lua_State *L, void *u, lua_CFunction gc);
+
+LUA_API void (lua_setfnzhook) (lua_State *L, lua_FnzHook f);
+#endif
+
 
 
 /*
@@ -36,6 +36,20 @@
 /* #define LUA_32BITS */
 
 
+/*
+@@ LUA_INLINE_CACHE enables per-site cache of field access on full
+** userdata, see 'lua_setinlinecache'.
+*/
+#define LUA_INLINE_CACHE
+
+
+/*
+@@ LUA_FNZ_HOOK enables a callback when full userdata is scheduled to
+** be finalized, see 'lua_setfnzhook'.
+*/
+#define LUA_FNZ_HOOK
+
+
 /*
 @@ LUA_USE_C89 controls the use of non-ISO-C89 features.
 ** Define it if you want Lua to avoid the use of a few C99 features
@@ -22,6 +22,7 @@
 #include "ldo.h"
 #include "lfunc.h"
 #include "lgc.h"
+#include "lmem.h"
 #include "lobject.h"
 #include "lopcodes.h"
 #include "lstate.h"
@@ -650,6 +651,176 @@ static void pushclosure (lua_State *L, Proto *p, UpVal **encup, StkId base,
 }
 
 
+#if defined(LUA_INLINE_CACHE)
+/*
+** {==================================================================
+** Inline cache of field access on full userdata
+** ===================================================================
+*/
+
+#define MAXICACHE	256
+
+/* guard failures before a site stops resolving until epoch changes */
+#define MAXICACHEMISS	8
+
+
+/*
+** callbacks use the lua api with 'ci' as their frame, give them room
+** for 'n' values pushed by us and LUA_MINSTACK of their own
+*/
+#define icache_reserve(L,ci,n) \
+  { luaD_checkstack(L, (n) + LUA_MINSTACK); \
+    ci->top = L->top + (n) + LUA_MINSTACK; }
+
+/*
+** entry of the site at 'pc', cache of a proto is created on first
+** use and sized by the number of table access instructions in it
+*/
+static ICacheEntry *icache_entry (lua_State *L, Proto *p, int pc) {
+  if (p->icache == NULL) {
+    int i, n = 0, size = 1;
+    for (i = 0; i < p->sizecode; i++) {
+      OpCode op = GET_OPCODE(p->code[i]);
+      if (op == OP_GETTABLE || op == OP_SETTABLE) n++;
+    }
+    while (size < n && size < MAXICACHE) size <<= 1;
+    p->icache = luaM_newvector(L, size, ICacheEntry);
+    p->sizeicache = size;
+    for (i = 0; i < size; i++) {
+      p->icache[i].mt = NULL;
+      p->icache[i].data = NULL;
+      p->icache[i].pc = -1;
+      p->icache[i].epoch = 0;
+      p->icache[i].misses = 0;
+    }
+  }
+  return &p->icache[pc & (p->sizeicache - 1)];
+}
+
+
+/*
+** count a guard failure of entry 'e', a site failing too often is
+** polymorphic, it's left to metamethods instead of resolving each time
+*/
+static void icache_miss (ICacheEntry *e) {
+  e->mt = NULL;
+  e->data = NULL;
+  if (e->misses < MAXICACHEMISS) e->misses++;
+}
+
+
+/*
+** find valid entry for userdata 'u' at current site, resolve it if
+** needed; return NULL if the site is not cacheable for now
+*/
+static ICacheEntry *icache_find (lua_State *L, CallInfo *ci, Udata *u,
+                                 const TValue *k, int isset) {
+  global_State *g = G(L);
+  Proto *p = clLvalue(ci->func)->p;
+  int pc = cast_int(ci->u.l.savedpc - p->code) - 1;
+  ICacheEntry *e = icache_entry(L, p, pc);
+  if (e->pc != pc || e->epoch != g->icacheepoch) {  /* new site or epoch */
+    e->pc = pc;
+    e->mt = NULL;
+    e->misses = 0;
+  }
+  else if (e->mt == u->metatable)
+    return e->data ? e : NULL;
+  else if (e->mt != NULL || e->misses > 0) {  /* seen other metatable */
+    icache_miss(e);
+  }
+  if (e->misses >= MAXICACHEMISS) return NULL;  /* megamorphic */
+  {
+    ptrdiff_t top = savestack(L, L->top);
+    ptrdiff_t citop = savestack(L, ci->top);
+    void *data = NULL;
+    int ok;
+    icache_reserve(L, ci, 2);
+    setuvalue(L, L->top, u);
+    setobj2s(L, L->top + 1, k);
+    L->top += 2;
+    ok = g->icacheresolve(L, cast_int(L->top - 2 - ci->func),
+                          cast_int(L->top - 1 - ci->func), isset, &data);
+    L->top = restorestack(L, top);
+    ci->top = restorestack(L, citop);
+    if (!ok) return NULL;
+    if (e->pc != pc) {  /* resolver ran code sharing this slot */
+      e->pc = pc;
+      e->misses = 0;
+    }
+    e->mt = u->metatable;
+    e->mt->icached = 1;
+    e->data = data;
+    e->epoch = g->icacheepoch;  /* resolver may bump epoch */
+  }
+  return e->data ? e : NULL;
+}
+
+
+/*
+** try 'val = t[k]' by cache, 't' is a full userdata with metatable
+*/
+static int icache_get (lua_State *L, CallInfo *ci, const TValue *t,
+                       const TValue *k, StkId val) {
+  Udata *u = uvalue(t);
+  ptrdiff_t res = savestack(L, val);
+  ptrdiff_t top;
+  ptrdiff_t citop;
+  ICacheEntry *e = icache_find(L, ci, u, k, 0);
+  if (e == NULL) return 0;
+  top = savestack(L, L->top);
+  citop = savestack(L, ci->top);
+  icache_reserve(L, ci, 0);
+  if (G(L)->icacheget(L, getudatamem(u), e->data) != 1) {
+    L->top = restorestack(L, top);
+    ci->top = restorestack(L, citop);
+    icache_miss(e);  /* resolve again next time */
+    return 0;
+  }
+  setobjs2s(L, restorestack(L, res), L->top - 1);
+  L->top = restorestack(L, top);
+  ci->top = restorestack(L, citop);
+  return 1;
+}
+
+
+/*
+** try 't[k] = v' by cache, 't' is a full userdata with metatable
+*/
+static int icache_set (lua_State *L, CallInfo *ci, const TValue *t,
+                       const TValue *k, const TValue *v) {
+  Udata *u = uvalue(t);
+  TValue val;
+  ptrdiff_t top, citop;
+  ICacheEntry *e;
+  setobj(L, &val, v);  /* 'v' may be in the stack */
+  e = icache_find(L, ci, u, k, 1);
+  if (e == NULL) return 0;
+  top = savestack(L, L->top);
+  citop = savestack(L, ci->top);
+  icache_reserve(L, ci, 1);
+  setobj2s(L, L->top, &val);
+  L->top++;
+  if (!G(L)->icacheset(L, getudatamem(u), e->data,
+                       cast_int(L->top - 1 - ci->func))) {
+    L->top = restorestack(L, top);
+    ci->top = restorestack(L, citop);
+    icache_miss(e);
+    return 0;
+  }
+  L->top = restorestack(L, top);
+  ci->top = restorestack(L, citop);
+  return 1;
+}
+
+#define icacheable(L,t,k) \
+  (G(L)->icacheget != NULL && ttisfulluserdata(t) && \
+   uvalue(t)->metatable != NULL && ttisshrstring(k))
+
+/* }================================================================== */
+#endif
+
+
 /*
 ** finish execution of an opcode interrupted by an yield
 */
@@ -842,6 +1013,14 @@ void luaV_execute (lua_State *L) {
       vmcase(OP_GETTABLE) {
         StkId rb = RB(i);
         TValue *rc = RKC(i);
+#if defined(LUA_INLINE_CACHE)
+        if (ISK(GETARG_C(i)) && icacheable(L, rb, rc)) {
+          int hit;
+          Protect(hit = icache_get(L, ci, rb, rc, ra));
+          if (hit) vmbreak;
+          ra = RA(i); rb = RB(i);
+        }
+#endif
         gettableProtected(L, rb, rc, ra);
         vmbreak;
       }
@@ -861,6 +1040,14 @@ void luaV_execute (lua_State *L) {
       vmcase(OP_SETTABLE) {
         TValue *rb = RKB(i);
         TValue *rc = RKC(i);
+#if defined(LUA_INLINE_CACHE)
+        if (ISK(GETARG_B(i)) && icacheable(L, ra, rb)) {
+          int hit;
+          Protect(hit = icache_set(L, ci, ra, rb, rc));
+          if (hit) vmbreak;
+          ra = RA(i); rc = RKC(i);
+        }
+#endif
         settableProtected(L, ra, rb, rc);
         vmbreak;
       }
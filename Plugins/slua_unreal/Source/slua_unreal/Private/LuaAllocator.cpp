@@ -0,0 +1,198 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "LuaAllocator.h"
+#include "Log.h"
+#include "Misc/ScopeLock.h"
+
+namespace NS_SLUA {
+
+    namespace {
+        const uint32 ClassSizes[LuaAllocator::NumSizeClasses] = {
+            16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512
+        };
+        const int LargeClass = LuaAllocator::NumSizeClasses;
+        const int MaxCachedPages = 16;
+
+        // size in 16 bytes unit -> size class
+        struct SizeClassTable {
+            uint8 index[LuaAllocator::MaxSmallSize / 16 + 1];
+            SizeClassTable() {
+                int sc = 0;
+                for (uint32 n = 0; n <= LuaAllocator::MaxSmallSize / 16; n++) {
+                    while (ClassSizes[sc] < n * 16) sc++;
+                    index[n] = sc;
+                }
+            }
+        } SizeClassOf;
+
+        FORCEINLINE int sizeClassOf(size_t size) {
+            if (size > LuaAllocator::MaxSmallSize) return LargeClass;
+            return SizeClassOf.index[(size + 15) >> 4];
+        }
+
+        // free pages of closed states, reused by states created later on any thread,
+        // pages aren't freed by destructor at exit, but by releaseCachedPages on module shutdown
+        struct PageCache {
+            void* pages[MaxCachedPages];
+            int32 num = 0;
+
+            void* pop() {
+                {
+                    FScopeLock lock(&pageLock);
+                    if (num > 0) return pages[--num];
+                }
+                return FMemory::Malloc(LuaAllocator::PageSize);
+            }
+
+            void push(void* page) {
+                {
+                    FScopeLock lock(&pageLock);
+                    if (num < MaxCachedPages) {
+                        pages[num++] = page;
+                        return;
+                    }
+                }
+                FMemory::Free(page);
+            }
+
+            FCriticalSection pageLock;
+        };
+        PageCache CachedPages;
+    }
+
+    LuaAllocator::LuaAllocator()
+        : bulkRelease(false)
+    {
+        FMemory::Memzero(classes);
+        FMemory::Memzero(stats);
+    }
+
+    LuaAllocator::~LuaAllocator()
+    {
+        for (auto page : pages)
+            CachedPages.push(page);
+        pages.Empty();
+    }
+
+    void LuaAllocator::releaseCachedPages()
+    {
+        FScopeLock lock(&CachedPages.pageLock);
+        for (int32 i = 0; i < CachedPages.num; i++)
+            FMemory::Free(CachedPages.pages[i]);
+        CachedPages.num = 0;
+    }
+
+    uint32 LuaAllocator::sizeOfClass(int index)
+    {
+        return index < NumSizeClasses ? ClassSizes[index] : 0;
+    }
+
+    void* LuaAllocator::alloc(void* ud, void* ptr, size_t osize, size_t nsize)
+    {
+        return ((LuaAllocator*)ud)->realloc(ptr, osize, nsize);
+    }
+
+    void* LuaAllocator::realloc(void* ptr, size_t osize, size_t nsize)
+    {
+        // when ptr is null, osize is the object type, not a size
+        if (!ptr) osize = 0;
+        int oc = osize > 0 ? sizeClassOf(osize) : -1;
+
+        if (nsize == 0) {
+            if (ptr) freeBlock(ptr, osize, oc);
+            return nullptr;
+        }
+
+        int nc = sizeClassOf(nsize);
+        if (ptr && oc == nc) {
+            if (nc != LargeClass) {
+                stats.reallocInPlace++;
+                return ptr;
+            }
+            stats.largeBytes += (int64)nsize - (int64)osize;
+            return FMemory::Realloc(ptr, nsize);
+        }
+
+        void* block = allocBlock(nsize, nc);
+        if (ptr && block) {
+            FMemory::Memcpy(block, ptr, FMath::Min(osize, nsize));
+            freeBlock(ptr, osize, oc);
+        }
+        return block;
+    }
+
+    void LuaAllocator::beginBulkRelease()
+    {
+        bulkRelease = true;
+    }
+
+    void* LuaAllocator::allocBlock(size_t size, int sc)
+    {
+        stats.allocCount[sc]++;
+        if (sc == LargeClass) {
+            stats.largeBytes += size;
+            return FMemory::Malloc(size);
+        }
+
+        SizeClass& cls = classes[sc];
+        if (cls.freeList) {
+            void* block = cls.freeList;
+            cls.freeList = *(void**)block;
+            return block;
+        }
+
+        uint32 blockSize = ClassSizes[sc];
+        if (cls.cur + blockSize > cls.end) {
+            // rest of old page is wasted, at most one block
+            uint8* page = (uint8*)CachedPages.pop();
+            pages.Add(page);
+            stats.pages++;
+            cls.cur = page;
+            cls.end = page + PageSize;
+        }
+        void* block = cls.cur;
+        cls.cur += blockSize;
+        return block;
+    }
+
+    void LuaAllocator::freeBlock(void* ptr, size_t size, int sc)
+    {
+        stats.freeCount[sc]++;
+        if (sc == LargeClass) {
+            stats.largeBytes -= size;
+            FMemory::Free(ptr);
+            return;
+        }
+
+        // pages will be released together
+        if (bulkRelease) return;
+
+        SizeClass& cls = classes[sc];
+        *(void**)ptr = cls.freeList;
+        cls.freeList = ptr;
+    }
+
+    void LuaAllocator::dumpStats() const
+    {
+        Log::Log("Lua allocator pages %d (%d kb), large %lld kb, realloc in place %llu",
+            stats.pages, stats.pages * (PageSize / 1024), stats.largeBytes / 1024, stats.reallocInPlace);
+        for (int i = 0; i <= NumSizeClasses; i++) {
+            uint64 live = stats.allocCount[i] - stats.freeCount[i];
+            if (i < NumSizeClasses)
+                Log::Log("size %4u: alloc %10llu free %10llu live %8llu", ClassSizes[i], stats.allocCount[i], stats.freeCount[i], live);
+            else
+                Log::Log("large    : alloc %10llu free %10llu live %8llu", stats.allocCount[i], stats.freeCount[i], live);
+        }
+    }
+}
@@ -20,8 +20,6 @@
 
 namespace NS_SLUA {
 
-    DefTypeName(LuaArray::Enumerator); 
-
     void LuaArray::reg(lua_State* L) {
         SluaUtil::reg(L,"Array",__ctor);
     }
@@ -63,6 +61,7 @@ namespace NS_SLUA {
         , isRef(bIsRef)
         , isNewInner(bIsNewInner)
     {
+        resolveElementFunctions();
         if (isRef)
         {
             array = buf;
@@ -80,6 +79,7 @@ namespace NS_SLUA {
         , isRef(bIsRef)
         , isNewInner(false)
     {
+        resolveElementFunctions();
         if (isRef)
         {
             array = buf;
@@ -110,6 +110,29 @@ namespace NS_SLUA {
         inner = nullptr;
     }
 
+    void LuaArray::resolveElementFunctions() {
+        pusher = LuaObject::getPusher(inner);
+        checker = LuaObject::getChecker(inner);
+    }
+
+    int LuaArray::pushElement(lua_State* L, int index) const {
+        if (!pusher) {
+            FString tn = inner->GetClass()->GetName();
+            luaL_error(L, "unsupport type %s to push", TCHAR_TO_UTF8(*tn));
+            return 0;
+        }
+        return pusher(L, inner, getRawPtr(index), nullptr);
+    }
+
+    void LuaArray::checkElement(lua_State* L, uint8* dest, int i) const {
+        if (!checker) {
+            FString tn = inner->GetClass()->GetName();
+            luaL_error(L, "unsupport param type %s to set", TCHAR_TO_UTF8(*tn));
+            return;
+        }
+        checker(L, inner, dest, i, true);
+    }
+
     void LuaArray::clear() {
         if(!inner) return;
 
@@ -167,13 +190,17 @@ namespace NS_SLUA {
     }
 
     uint8* LuaArray::add() {
+        return addItems(1);
+    }
+
+    uint8* LuaArray::addItems(int count) {
 #if ENGINE_MAJOR_VERSION==5
-        const int index = array->Add(1, inner->ElementSize, GetPropertyAlignment(inner));
+        const int index = array->Add(count, inner->ElementSize, GetPropertyAlignment(inner));
 #else
-        const int index = array->Add(1, inner->ElementSize);
+        const int index = array->Add(count, inner->ElementSize);
 #endif
         
-        constructItems(index, 1);
+        constructItems(index, count);
         return getRawPtr(index);
     }
 
@@ -292,12 +319,11 @@ namespace NS_SLUA {
             luaL_error(L, "arg 1 expect LuaArray, but got nil!");
         }
         int i = LuaObject::checkValue<int>(L,2);
-        FProperty* element = UD->inner;
         if (!UD->isValidIndex(i)) {
             luaL_error(L, "Array get index %d out of range", i);
             return 0;
         }
-        return LuaObject::push(L,element,UD->getRawPtr(i));
+        return UD->pushElement(L,i);
     }
 
     int LuaArray::Set(lua_State* L)
@@ -308,7 +334,7 @@ namespace NS_SLUA {
         }
         int index = LuaObject::checkValue<int>(L, 2);
         FProperty* element = UD->inner;
-        auto checker = LuaObject::getChecker(element);
+        auto checker = UD->checker;
         if (checker) {
             if (!UD->isValidIndex(index))
                 luaL_error(L, "Array set index %d out of range", index);
@@ -329,7 +355,7 @@ namespace NS_SLUA {
         }
         // get element property
         FProperty* element = UD->inner;
-        auto checker = LuaObject::getChecker(element);
+        auto checker = UD->checker;
         if(checker) {
             checker(L,element,UD->add(),2,true);
             // return num of array
@@ -350,7 +376,7 @@ namespace NS_SLUA {
         // get element property
         FProperty* element = UD->inner;
         uint8* newElement = UD->add();
-        auto checker = LuaObject::getChecker(element);
+        auto checker = UD->checker;
         if(checker) {
 	        checker(L,element,newElement,2,true);
             int32 num = UD->array->Num();
@@ -378,7 +404,7 @@ namespace NS_SLUA {
         
         // get element property
         FProperty* element = UD->inner;
-        auto checker = LuaObject::getChecker(element);
+        auto checker = UD->checker;
         if(checker) {
 
             if(!UD->isValidIndex(index))
@@ -422,32 +448,97 @@ namespace NS_SLUA {
         if (!UD) {
             luaL_error(L, "arg 1 expect LuaArray, but got nil!");
         }
-        auto iter = new LuaArray::Enumerator();
-        
-        iter->arr = UD;
-        iter->index = 0;
+        // stateless iterator, array itself is the state and index is the control variable,
+        // so no enumerator need to be allocated
         lua_pushcfunction(L, LuaArray::Enumerable);
-        LuaObject::pushType(L, iter, "LuaArray::Enumerator", nullptr, LuaArray::Enumerator::gc, 1);
-        // hold referrence of LuaArray, avoid gc
         lua_pushvalue(L, 1);
-        lua_setuservalue(L,3);
-        LuaObject::pushNil(L);
-        
+        LuaObject::push(L, -1);
         return 3;
     }
 
     int LuaArray::Enumerable(lua_State* L) {
-        CheckUD(LuaArray::Enumerator, L, 1);
-        auto arr = UD->arr;
-        if (arr->isValidIndex(UD->index)) {
-            auto element = arr->inner;
-            auto es = element->ElementSize;
-            auto parms = ((uint8*)arr->array->GetData()) + UD->index * es;
-            LuaObject::push(L, UD->index);
-            LuaObject::push(L, element, parms);
-            UD->index += 1;
+        CheckUD(LuaArray, L, 1);
+        if (!UD) {
+            return 0;
+        }
+        int index = (int)luaL_checkinteger(L, 2) + 1;
+        if (UD->isValidIndex(index)) {
+            LuaObject::push(L, index);
+            UD->pushElement(L, index);
             return 2;
-        } 
+        }
+        return 0;
+    }
+
+    int LuaArray::ToTable(lua_State* L) {
+        CheckUD(LuaArray, L, 1);
+        if (!UD) {
+            luaL_error(L, "arg 1 expect LuaArray, but got nil!");
+        }
+        int num = UD->num();
+        lua_createtable(L, num, 0);
+        for (int i = 0; i < num; i++) {
+            UD->pushElement(L, i);
+            lua_rawseti(L, -2, i + 1);
+        }
+        return 1;
+    }
+
+    int LuaArray::FromTable(lua_State* L) {
+        CheckUD(LuaArray, L, 1);
+        if (!UD) {
+            luaL_error(L, "arg 1 expect LuaArray, but got nil!");
+        }
+        luaL_checktype(L, 2, LUA_TTABLE);
+        int num = (int)lua_rawlen(L, 2);
+        UD->clear();
+        if (num > 0) {
+            UD->addItems(num);
+            for (int i = 0; i < num; i++) {
+                lua_rawgeti(L, 2, i + 1);
+                UD->checkElement(L, UD->getRawPtr(i), lua_gettop(L));
+                lua_pop(L, 1);
+            }
+        }
+        return LuaObject::push(L, num);
+    }
+
+    int LuaArray::Index(lua_State* L) {
+        if (lua_type(L, 2) != LUA_TNUMBER) {
+            // method of array
+            lua_getmetatable(L, 1);
+            lua_pushvalue(L, 2);
+            lua_rawget(L, -2);
+            return 1;
+        }
+        CheckUD(LuaArray, L, 1);
+        if (!UD) {
+            luaL_error(L, "arg 1 expect LuaArray, but got nil!");
+        }
+        int isnum = 0;
+        lua_Integer index = lua_tointegerx(L, 2, &isnum);
+        if (!isnum || !UD->isValidIndex((int)index)) {
+            return 0;
+        }
+        return UD->pushElement(L, (int)index);
+    }
+
+    int LuaArray::NewIndex(lua_State* L) {
+        CheckUD(LuaArray, L, 1);
+        if (!UD) {
+            luaL_error(L, "arg 1 expect LuaArray, but got nil!");
+        }
+        int isnum = 0;
+        lua_Integer index = lua_tointegerx(L, 2, &isnum);
+        if (!isnum) {
+            luaL_error(L, "Array set index expect integer, but got %s", luaL_typename(L, 2));
+            return 0;
+        }
+        if (!UD->isValidIndex((int)index)) {
+            luaL_error(L, "Array set index %d out of range", (int)index);
+            return 0;
+        }
+        UD->checkElement(L, UD->getRawPtr((int)index), 3);
         return 0;
     }
 
@@ -481,8 +572,12 @@ namespace NS_SLUA {
         RegMetaMethod(L,Remove);
         RegMetaMethod(L,Clear);
         RegMetaMethod(L,CreateValueTypeObject);
+        RegMetaMethod(L,ToTable);
+        RegMetaMethod(L,FromTable);
 
         RegMetaMethodByName(L, "__pairs", Pairs);
+        RegMetaMethodByName(L, "__index", Index);
+        RegMetaMethodByName(L, "__newindex", NewIndex);
 
         return 0;
     }
@@ -500,10 +595,4 @@ namespace NS_SLUA {
         delete userdata->ud;
         return 0;
     }
-
-    int LuaArray::Enumerator::gc(lua_State* L) {
-        CheckUD(LuaArray::Enumerator, L, 1);
-        delete UD;
-        return 0;
-    }
 }
\ No newline at end of file
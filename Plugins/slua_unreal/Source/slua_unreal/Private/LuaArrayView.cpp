@@ -0,0 +1,421 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "LuaArrayView.h"
+#include "LuaArray.h"
+#include "LuaObject.h"
+#include "SluaLib.h"
+#include <type_traits>
+
+#define CHECK_VIEW(L) \
+    CheckUD(LuaArrayView, L, 1); \
+    if (!UD) { \
+        luaL_error(L, "arg 1 expect LuaArrayView, but got nil!"); \
+    }
+
+// run statements with T typedef'd to element type of view
+#define VIEW_DISPATCH(TYPE, ...) \
+    switch (TYPE) { \
+    case LuaArrayView::Int8: { typedef int8 T; __VA_ARGS__; break; } \
+    case LuaArrayView::UInt8: { typedef uint8 T; __VA_ARGS__; break; } \
+    case LuaArrayView::Int16: { typedef int16 T; __VA_ARGS__; break; } \
+    case LuaArrayView::UInt16: { typedef uint16 T; __VA_ARGS__; break; } \
+    case LuaArrayView::Int32: { typedef int32 T; __VA_ARGS__; break; } \
+    case LuaArrayView::UInt32: { typedef uint32 T; __VA_ARGS__; break; } \
+    case LuaArrayView::Int64: { typedef int64 T; __VA_ARGS__; break; } \
+    case LuaArrayView::UInt64: { typedef uint64 T; __VA_ARGS__; break; } \
+    case LuaArrayView::Float: { typedef float T; __VA_ARGS__; break; } \
+    case LuaArrayView::Double: { typedef double T; __VA_ARGS__; break; } \
+    default: break; \
+    }
+
+namespace NS_SLUA {
+
+    DefTypeName(LuaArrayView);
+
+    namespace {
+        const char* TypeNames[] = { "i8", "u8", "i16", "u16", "i32", "u32", "i64", "u64", "f32", "f64" };
+        const uint8 TypeSizes[] = { 1, 1, 2, 2, 4, 4, 8, 8, 4, 8 };
+        static_assert(sizeof(TypeNames) / sizeof(TypeNames[0]) == LuaArrayView::TypeNum, "TypeNames should match ElementType");
+        static_assert(sizeof(TypeSizes) == LuaArrayView::TypeNum, "TypeSizes should match ElementType");
+
+        template<typename T>
+        typename std::enable_if<std::is_integral<T>::value>::type pushNumber(lua_State* L, T v) {
+            lua_pushinteger(L, (lua_Integer)v);
+        }
+
+        template<typename T>
+        typename std::enable_if<!std::is_integral<T>::value>::type pushNumber(lua_State* L, T v) {
+            lua_pushnumber(L, (lua_Number)v);
+        }
+
+        template<typename T>
+        typename std::enable_if<std::is_integral<T>::value, T>::type checkNumber(lua_State* L, int p) {
+            return (T)luaL_checkinteger(L, p);
+        }
+
+        template<typename T>
+        typename std::enable_if<!std::is_integral<T>::value, T>::type checkNumber(lua_State* L, int p) {
+            return (T)luaL_checknumber(L, p);
+        }
+
+        void checkRange(lua_State* L, int32 num, lua_Integer start, lua_Integer count) {
+            if (start < 0 || count < 0 || start + count > num)
+                luaL_error(L, "view range [%d, %d) out of array num %d", (int)start, (int)(start + count), num);
+        }
+
+        // optional start and count at p and p+1, default is whole array
+        void optRange(lua_State* L, int p, int32 num, int32& start, int32& count) {
+            lua_Integer s = luaL_optinteger(L, p, 0);
+            lua_Integer c = luaL_optinteger(L, p + 1, num - s);
+            checkRange(L, num, s, c);
+            start = (int32)s;
+            count = (int32)c;
+        }
+
+        struct AddOp { template<typename T> static T apply(T a, T b) { return (T)(a + b); } };
+        struct SubOp { template<typename T> static T apply(T a, T b) { return (T)(a - b); } };
+        struct MulOp { template<typename T> static T apply(T a, T b) { return (T)(a * b); } };
+        struct DivOp { template<typename T> static T apply(T a, T b) { return a / b; } };
+        struct MinOp { template<typename T> static T apply(T a, T b) { return b < a ? b : a; } };
+        struct MaxOp { template<typename T> static T apply(T a, T b) { return a < b ? b : a; } };
+        struct BandOp { template<typename T> static T apply(T a, T b) { return (T)(a & b); } };
+        struct BorOp { template<typename T> static T apply(T a, T b) { return (T)(a | b); } };
+        struct BxorOp { template<typename T> static T apply(T a, T b) { return (T)(a ^ b); } };
+
+        // kernels are plain loops without branch, let compiler vectorize them,
+        // reductions use 4 accumulators to break dependency chain
+
+        template<typename T>
+        void fillKernel(T* p, int32 count, T v) {
+            for (int32 i = 0; i < count; i++)
+                p[i] = v;
+        }
+
+        template<typename T>
+        typename std::conditional<std::is_integral<T>::value, int64, double>::type sumKernel(const T* p, int32 count) {
+            typedef typename std::conditional<std::is_integral<T>::value, int64, double>::type Acc;
+            Acc a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+            int32 i = 0;
+            for (; i + 4 <= count; i += 4) {
+                a0 += p[i];
+                a1 += p[i + 1];
+                a2 += p[i + 2];
+                a3 += p[i + 3];
+            }
+            for (; i < count; i++)
+                a0 += p[i];
+            return (a0 + a1) + (a2 + a3);
+        }
+
+        // count should be greater than 0
+        template<typename Op, typename T>
+        T reduceKernel(const T* p, int32 count) {
+            T a0 = p[0], a1 = p[0], a2 = p[0], a3 = p[0];
+            int32 i = 0;
+            for (; i + 4 <= count; i += 4) {
+                a0 = Op::apply(a0, p[i]);
+                a1 = Op::apply(a1, p[i + 1]);
+                a2 = Op::apply(a2, p[i + 2]);
+                a3 = Op::apply(a3, p[i + 3]);
+            }
+            for (; i < count; i++)
+                a0 = Op::apply(a0, p[i]);
+            return Op::apply(Op::apply(a0, a1), Op::apply(a2, a3));
+        }
+
+        // p[i] = op(p[i], q[i]) if q given, otherwise p[i] = op(p[i], v)
+        template<typename Op, typename T>
+        void mapKernel(T* p, const T* q, T v, int32 count) {
+            if (q) {
+                for (int32 i = 0; i < count; i++)
+                    p[i] = Op::apply(p[i], q[i]);
+            }
+            else {
+                for (int32 i = 0; i < count; i++)
+                    p[i] = Op::apply(p[i], v);
+            }
+        }
+
+        template<typename T>
+        bool mapTypedOp(const char* op, T* p, const T* q, T v, int32 count, std::true_type /* integral */) {
+            if (strcmp(op, "band") == 0) mapKernel<BandOp>(p, q, v, count);
+            else if (strcmp(op, "bor") == 0) mapKernel<BorOp>(p, q, v, count);
+            else if (strcmp(op, "bxor") == 0) mapKernel<BxorOp>(p, q, v, count);
+            else return false;
+            return true;
+        }
+
+        template<typename T>
+        bool mapTypedOp(const char* op, T* p, const T* q, T v, int32 count, std::false_type /* integral */) {
+            if (strcmp(op, "div") == 0) mapKernel<DivOp>(p, q, v, count);
+            else return false;
+            return true;
+        }
+
+        template<typename T>
+        void mapOp(lua_State* L, const char* op, T* p, const T* q, T v, int32 count) {
+            if (strcmp(op, "add") == 0) mapKernel<AddOp>(p, q, v, count);
+            else if (strcmp(op, "sub") == 0) mapKernel<SubOp>(p, q, v, count);
+            else if (strcmp(op, "mul") == 0) mapKernel<MulOp>(p, q, v, count);
+            else if (strcmp(op, "min") == 0) mapKernel<MinOp>(p, q, v, count);
+            else if (strcmp(op, "max") == 0) mapKernel<MaxOp>(p, q, v, count);
+            else if (!mapTypedOp(op, p, q, v, count, std::is_integral<T>()))
+                luaL_error(L, "unsupport map op %s", op);
+        }
+    }
+
+    void LuaArrayView::reg(lua_State* L) {
+        SluaUtil::reg(L, "view", __ctor);
+    }
+
+    LuaArrayView::ElementType LuaArrayView::getElementType(FProperty* inner) {
+        FFieldClass* cls = inner->GetClass();
+        if (cls == FInt8Property::StaticClass()) return Int8;
+        if (cls == FByteProperty::StaticClass()) return UInt8;
+        if (cls == FInt16Property::StaticClass()) return Int16;
+        if (cls == FUInt16Property::StaticClass()) return UInt16;
+        if (cls == FIntProperty::StaticClass()) return Int32;
+        if (cls == FUInt32Property::StaticClass()) return UInt32;
+        if (cls == FInt64Property::StaticClass()) return Int64;
+        if (cls == FUInt64Property::StaticClass()) return UInt64;
+        if (cls == FFloatProperty::StaticClass()) return Float;
+        if (cls == FDoubleProperty::StaticClass()) return Double;
+        return TypeNum;
+    }
+
+    int LuaArrayView::push(lua_State* L, int p, ElementType type) {
+        p = lua_absindex(L, p);
+        CheckUD(LuaArray, L, p);
+        if (!UD) {
+            luaL_error(L, "arg %d expect LuaArray, but got nil!", p);
+        }
+        auto arrUD = reinterpret_cast<GenericUserData*>(lua_touserdata(L, p));
+
+        // view is stored in userdata memory, no heap object
+        auto ud = lua_newuserdata(L, sizeof(UserData<LuaArrayView*>) + sizeof(LuaArrayView) + alignof(LuaArrayView) - 1);
+        if (!ud) luaL_error(L, "out of memory to new ud");
+        auto udptr = reinterpret_cast<UserData<LuaArrayView*>*>(ud);
+        auto view = reinterpret_cast<LuaArrayView*>(Align(reinterpret_cast<uint8*>(udptr + 1), alignof(LuaArrayView)));
+        view->arr = UD;
+        view->arrUD = arrUD;
+        view->type = type;
+        udptr->parent = nullptr;
+        udptr->ud = view;
+        udptr->flag = UD_INLINE;
+
+        if (luaL_newmetatable(L, "LuaArrayView")) {
+            setupMT(L);
+            lua_pushcfunction(L, gc);
+            lua_setfield(L, -2, "__gc");
+        }
+        lua_setmetatable(L, -2);
+
+        // hold referrence of LuaArray, avoid gc
+        lua_pushvalue(L, p);
+        lua_setuservalue(L, -2);
+        // array property of UObject or struct, view is freed with its owner
+        if (arrUD->parent) {
+            LuaObject::linkProp(L, arrUD->parent, udptr);
+        }
+        return 1;
+    }
+
+    uint8* LuaArrayView::data(lua_State* L, int32& num) const {
+        if (arrUD->flag & UD_HADFREE)
+            luaL_error(L, "array of view had been freed");
+        FScriptArray* array = arr->get();
+        num = array->Num();
+        return (uint8*)array->GetData();
+    }
+
+    int LuaArrayView::__ctor(lua_State* L) {
+        CheckUD(LuaArray, L, 1);
+        if (!UD) {
+            luaL_error(L, "arg 1 expect LuaArray, but got nil!");
+        }
+        ElementType type = getElementType(UD->getInner());
+        if (type == TypeNum) {
+            FString tn = UD->getInner()->GetClass()->GetName();
+            luaL_error(L, "view only support array of numeric element, but got %s", TCHAR_TO_UTF8(*tn));
+        }
+        if (!lua_isnoneornil(L, 2)) {
+            const char* tn = luaL_checkstring(L, 2);
+            if (strcmp(tn, TypeNames[type]) != 0)
+                luaL_error(L, "view type %s doesn't match array element type %s", tn, TypeNames[type]);
+        }
+        return push(L, 1, type);
+    }
+
+    int LuaArrayView::Index(lua_State* L) {
+        if (lua_type(L, 2) != LUA_TNUMBER) {
+            // method of view
+            lua_getmetatable(L, 1);
+            lua_pushvalue(L, 2);
+            lua_rawget(L, -2);
+            return 1;
+        }
+        CHECK_VIEW(L);
+        int32 num;
+        uint8* p = UD->data(L, num);
+        int isnum = 0;
+        lua_Integer index = lua_tointegerx(L, 2, &isnum);
+        if (!isnum || index < 0 || index >= num) {
+            return 0;
+        }
+        VIEW_DISPATCH(UD->type, pushNumber(L, ((T*)p)[index]); return 1);
+        return 0;
+    }
+
+    int LuaArrayView::NewIndex(lua_State* L) {
+        CHECK_VIEW(L);
+        int32 num;
+        uint8* p = UD->data(L, num);
+        int isnum = 0;
+        lua_Integer index = lua_tointegerx(L, 2, &isnum);
+        if (!isnum) {
+            luaL_error(L, "view set index expect integer, but got %s", luaL_typename(L, 2));
+        }
+        if (index < 0 || index >= num) {
+            luaL_error(L, "view set index %d out of range", (int)index);
+        }
+        VIEW_DISPATCH(UD->type, ((T*)p)[index] = checkNumber<T>(L, 3));
+        return 0;
+    }
+
+    int LuaArrayView::Num(lua_State* L) {
+        CHECK_VIEW(L);
+        int32 num;
+        UD->data(L, num);
+        return LuaObject::push(L, num);
+    }
+
+    int LuaArrayView::Type(lua_State* L) {
+        CHECK_VIEW(L);
+        lua_pushstring(L, TypeNames[UD->type]);
+        return 1;
+    }
+
+    int LuaArrayView::Fill(lua_State* L) {
+        CHECK_VIEW(L);
+        int32 num, start, count;
+        uint8* p = UD->data(L, num);
+        optRange(L, 3, num, start, count);
+        VIEW_DISPATCH(UD->type, fillKernel((T*)p + start, count, checkNumber<T>(L, 2)));
+        return 0;
+    }
+
+    int LuaArrayView::Copy(lua_State* L) {
+        CHECK_VIEW(L);
+        auto src = LuaObject::checkUD<LuaArrayView>(L, 2);
+        if (!src) {
+            luaL_error(L, "arg 2 expect LuaArrayView, but got nil!");
+        }
+        if (src->type != UD->type) {
+            luaL_error(L, "can't copy view of %s to view of %s", TypeNames[src->type], TypeNames[UD->type]);
+        }
+        int32 num, srcNum;
+        uint8* p = UD->data(L, num);
+        uint8* q = src->data(L, srcNum);
+        lua_Integer start = luaL_optinteger(L, 3, 0);
+        lua_Integer srcStart = luaL_optinteger(L, 4, 0);
+        lua_Integer count = luaL_optinteger(L, 5, FMath::Min<lua_Integer>(num - start, srcNum - srcStart));
+        checkRange(L, num, start, count);
+        checkRange(L, srcNum, srcStart, count);
+        const int32 size = TypeSizes[UD->type];
+        FMemory::Memmove(p + start * size, q + srcStart * size, count * size);
+        return LuaObject::push(L, (int32)count);
+    }
+
+    int LuaArrayView::Sum(lua_State* L) {
+        CHECK_VIEW(L);
+        int32 num, start, count;
+        uint8* p = UD->data(L, num);
+        optRange(L, 2, num, start, count);
+        VIEW_DISPATCH(UD->type, pushNumber(L, sumKernel((const T*)p + start, count)); return 1);
+        return 0;
+    }
+
+    int LuaArrayView::Min(lua_State* L) {
+        CHECK_VIEW(L);
+        int32 num, start, count;
+        uint8* p = UD->data(L, num);
+        optRange(L, 2, num, start, count);
+        if (count == 0) {
+            return 0;
+        }
+        VIEW_DISPATCH(UD->type, pushNumber(L, reduceKernel<MinOp>((const T*)p + start, count)); return 1);
+        return 0;
+    }
+
+    int LuaArrayView::Max(lua_State* L) {
+        CHECK_VIEW(L);
+        int32 num, start, count;
+        uint8* p = UD->data(L, num);
+        optRange(L, 2, num, start, count);
+        if (count == 0) {
+            return 0;
+        }
+        VIEW_DISPATCH(UD->type, pushNumber(L, reduceKernel<MaxOp>((const T*)p + start, count)); return 1);
+        return 0;
+    }
+
+    int LuaArrayView::Map(lua_State* L) {
+        CHECK_VIEW(L);
+        const char* op = luaL_checkstring(L, 2);
+        int32 num, start, count;
+        uint8* p = UD->data(L, num);
+        optRange(L, 4, num, start, count);
+        uint8* q = nullptr;
+        if (lua_type(L, 3) == LUA_TUSERDATA) {
+            auto other = LuaObject::checkUD<LuaArrayView>(L, 3);
+            if (!other || other->type != UD->type) {
+                luaL_error(L, "map operand expect view of %s", TypeNames[UD->type]);
+            }
+            int32 otherNum;
+            q = other->data(L, otherNum);
+            if (otherNum < start + count) {
+                luaL_error(L, "map operand num %d is less than %d", otherNum, start + count);
+            }
+        }
+        VIEW_DISPATCH(UD->type, mapOp(L, op, (T*)p + start, q ? (const T*)q + start : nullptr, q ? T() : checkNumber<T>(L, 3), count));
+        return 0;
+    }
+
+    int LuaArrayView::setupMT(lua_State* L) {
+        LuaObject::setupMTSelfSearch(L);
+
+        RegMetaMethod(L, Num);
+        RegMetaMethod(L, Type);
+        RegMetaMethod(L, Fill);
+        RegMetaMethod(L, Copy);
+        RegMetaMethod(L, Sum);
+        RegMetaMethod(L, Min);
+        RegMetaMethod(L, Max);
+        RegMetaMethod(L, Map);
+
+        RegMetaMethodByName(L, "__index", Index);
+        RegMetaMethodByName(L, "__newindex", NewIndex);
+        RegMetaMethodByName(L, "__len", Num);
+        return 0;
+    }
+
+    int LuaArrayView::gc(lua_State* L) {
+        auto udptr = (UserData<LuaArrayView*>*)luaL_testudata(L, 1, "LuaArrayView");
+        if (udptr && udptr->parent) {
+            LuaObject::unlinkProp(L, udptr);
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,246 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "LuaBytecodeCache.h"
+#include "Log.h"
+#include "lauxlib.h"
+#include "Hash/CityHash.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/IConsoleManager.h"
+#include "Runtime/Launch/Resources/Version.h"
+
+namespace NS_SLUA {
+
+    static int32 BytecodeCache = 0;
+    FAutoConsoleVariableRef CVarSluaBytecodeCache(
+        TEXT("slua.BytecodeCache"),
+        BytecodeCache,
+        TEXT("Load lua source from bytecode cache if source not changed.\n"),
+        ECVF_Default);
+
+    static int32 BytecodeCacheStrip = 0;
+    FAutoConsoleVariableRef CVarSluaBytecodeCacheStrip(
+        TEXT("slua.BytecodeCacheStrip"),
+        BytecodeCacheStrip,
+        TEXT("Strip debug info from cached bytecode, tracebacks and breakpoints lose line info.\n"),
+        ECVF_Default);
+
+    static int32 BytecodeCacheDisk = 1;
+    FAutoConsoleVariableRef CVarSluaBytecodeCacheDisk(
+        TEXT("slua.BytecodeCacheDisk"),
+        BytecodeCacheDisk,
+        TEXT("Save bytecode cache to Saved/LuaBytecode.\n"),
+        ECVF_Default);
+
+    namespace {
+        const int MaxLoadRecords = 4096;
+        FCriticalSection CacheLock;
+        TMap<uint64, LuaBytecodePtr> CacheMap;
+
+        struct LoadRecord {
+            FString chunk;
+            uint32 size;
+            double seconds;
+            LuaBytecodeCache::LoadType type;
+        };
+        TArray<LoadRecord> LoadRecords;
+
+        // header of cache file, file is ignored if anything mismatch
+        struct DiskHeader {
+            uint32 magic;
+            uint32 loaderVersion;
+            uint32 luaVersion;
+            uint32 engineVersion;
+            uint64 sourceHash;
+            uint32 size;
+            uint32 reserved;
+        };
+        const uint32 DiskMagic = 0x43424c53; // "SLBC"
+        const uint32 EngineVersion = ENGINE_MAJOR_VERSION * 10000 + ENGINE_MINOR_VERSION * 100 + ENGINE_PATCH_VERSION;
+
+        DiskHeader makeDiskHeader(const uint8* buf, uint32 len, uint32 size) {
+            DiskHeader header;
+            FMemory::Memzero(header);
+            header.magic = DiskMagic;
+            header.loaderVersion = LuaBytecodeCache::LoaderVersion;
+            header.luaVersion = LUA_VERSION_NUM;
+            header.engineVersion = EngineVersion;
+            header.sourceHash = CityHash64((const char*)buf, len);
+            header.size = size;
+            return header;
+        }
+
+        FString cacheFilePath(uint64 key) {
+            return FPaths::ProjectSavedDir() / TEXT("LuaBytecode") / FString::Printf(TEXT("%016llx.luac"), key);
+        }
+
+        int writer(lua_State* L, const void* p, size_t sz, void* ud) {
+            auto out = (TArray<uint8>*)ud;
+            out->Append((const uint8*)p, sz);
+            return 0;
+        }
+    }
+
+    bool LuaBytecodeCache::isEnabled()
+    {
+        return !!BytecodeCache;
+    }
+
+    bool LuaBytecodeCache::isStrip()
+    {
+        return !!BytecodeCacheStrip;
+    }
+
+    uint64 LuaBytecodeCache::hash(const uint8* buf, uint32 len, const char* chunk)
+    {
+        // bytecode depends on lua version and number size too
+        uint64 seed = ((uint64)LoaderVersion << 32) | ((uint64)LUA_VERSION_NUM << 8)
+            | (sizeof(lua_Number) << 4) | (sizeof(void*) << 1) | (isStrip() ? 1 : 0);
+        uint64 key = CityHash64WithSeed((const char*)buf, len, seed);
+        if (!isStrip() && chunk)
+            key = CityHash64WithSeed(chunk, strlen(chunk), key);
+        return key;
+    }
+
+    LuaBytecodePtr LuaBytecodeCache::find(uint64 key)
+    {
+        FScopeLock lock(&CacheLock);
+        auto ptr = CacheMap.Find(key);
+        return ptr ? *ptr : LuaBytecodePtr();
+    }
+
+    void LuaBytecodeCache::add(uint64 key, LuaBytecodePtr bytecode)
+    {
+        FScopeLock lock(&CacheLock);
+        CacheMap.Add(key, bytecode);
+    }
+
+    LuaBytecodePtr LuaBytecodeCache::dump(lua_State* L, bool strip)
+    {
+        auto bytecode = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
+        if (lua_dump(L, writer, &bytecode.Get(), strip ? 1 : 0) != 0)
+            return LuaBytecodePtr();
+        return bytecode;
+    }
+
+    LuaBytecodePtr LuaBytecodeCache::loadDisk(uint64 key, const uint8* buf, uint32 len)
+    {
+        TArray<uint8> data;
+        if (!FFileHelper::LoadFileToArray(data, *cacheFilePath(key), FILEREAD_Silent) || data.Num() < (int32)sizeof(DiskHeader))
+            return LuaBytecodePtr();
+        // written by other engine or lua version, or hash collision of source
+        DiskHeader expect = makeDiskHeader(buf, len, data.Num() - sizeof(DiskHeader));
+        if (FMemory::Memcmp(data.GetData(), &expect, sizeof(DiskHeader)) != 0)
+            return LuaBytecodePtr();
+        data.RemoveAt(0, sizeof(DiskHeader), false);
+        return MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(data));
+    }
+
+    void LuaBytecodeCache::saveDisk(uint64 key, const uint8* buf, uint32 len, const TArray<uint8>& bytecode)
+    {
+        DiskHeader header = makeDiskHeader(buf, len, bytecode.Num());
+        TArray<uint8> data;
+        data.Reserve(sizeof(DiskHeader) + bytecode.Num());
+        data.Append((const uint8*)&header, sizeof(DiskHeader));
+        data.Append(bytecode);
+        FFileHelper::SaveArrayToFile(data, *cacheFilePath(key));
+    }
+
+    int LuaBytecodeCache::loadBuffer(lua_State* L, const uint8* buf, uint32 len, const char* chunk)
+    {
+        // precompiled chunk can't be cached again
+        if (!isEnabled() || len == 0 || buf[0] == LUA_SIGNATURE[0])
+            return luaL_loadbuffer(L, (const char*)buf, len, chunk);
+
+        double start = FPlatformTime::Seconds();
+        uint64 key = hash(buf, len, chunk);
+        LoadType type = LoadMemoryCache;
+        LuaBytecodePtr bytecode = find(key);
+        if (!bytecode.IsValid() && BytecodeCacheDisk) {
+            bytecode = loadDisk(key, buf, len);
+            if (bytecode.IsValid()) {
+                type = LoadDiskCache;
+                add(key, bytecode);
+            }
+        }
+
+        if (bytecode.IsValid()) {
+            if (luaL_loadbufferx(L, (const char*)bytecode->GetData(), bytecode->Num(), chunk, "b") == 0) {
+                record(chunk, len, FPlatformTime::Seconds() - start, type);
+                return 0;
+            }
+            // broken cache, compile from source again
+            Log::Error("Bad bytecode cache of %s: %s", chunk, lua_tostring(L, -1));
+            lua_pop(L, 1);
+        }
+
+        int ret = luaL_loadbuffer(L, (const char*)buf, len, chunk);
+        if (ret != 0)
+            return ret;
+        record(chunk, len, FPlatformTime::Seconds() - start, LoadSource);
+
+        bytecode = dump(L, isStrip());
+        if (bytecode.IsValid()) {
+            add(key, bytecode);
+            if (BytecodeCacheDisk)
+                saveDisk(key, buf, len, *bytecode);
+        }
+        return 0;
+    }
+
+    void LuaBytecodeCache::record(const char* chunk, uint32 size, double seconds, LoadType type)
+    {
+        FScopeLock lock(&CacheLock);
+        if (LoadRecords.Num() < MaxLoadRecords)
+            LoadRecords.Add({ UTF8_TO_TCHAR(chunk), size, seconds, type });
+    }
+
+    void LuaBytecodeCache::report()
+    {
+        FScopeLock lock(&CacheLock);
+        static const TCHAR* TypeNames[] = { TEXT("source"), TEXT("memory"), TEXT("disk"), TEXT("prefetch"), TEXT("template") };
+        const int NumTypes = LoadTemplate + 1;
+        double total[NumTypes] = { 0.0 };
+        int count[NumTypes] = { 0 };
+        for (auto& rec : LoadRecords) {
+            total[rec.type] += rec.seconds;
+            count[rec.type]++;
+            UE_LOG(Slua, Log, TEXT("%-8s %8.3fms %8u bytes %s"), TypeNames[rec.type], rec.seconds * 1000.0, rec.size, *rec.chunk);
+        }
+        for (int i = 0; i < NumTypes; i++) {
+            UE_LOG(Slua, Log, TEXT("Load from %s: %d chunks, %.3fms"), TypeNames[i], count[i], total[i] * 1000.0);
+        }
+        UE_LOG(Slua, Log, TEXT("Bytecode cache entries %d"), CacheMap.Num());
+    }
+
+    void LuaBytecodeCache::clear()
+    {
+        FScopeLock lock(&CacheLock);
+        CacheMap.Empty();
+        LoadRecords.Empty();
+    }
+
+    static FAutoConsoleCommand CVarBytecodeCacheReport(
+        TEXT("slua.BytecodeCacheReport"),
+        TEXT("Print lua chunk load time, from source or bytecode cache"),
+        FConsoleCommandDelegate::CreateStatic(LuaBytecodeCache::report),
+        ECVF_Cheat);
+
+    static FAutoConsoleCommand CVarBytecodeCacheClear(
+        TEXT("slua.ClearBytecodeCache"),
+        TEXT("Clear in-memory bytecode cache and load records"),
+        FConsoleCommandDelegate::CreateStatic(LuaBytecodeCache::clear),
+        ECVF_Cheat);
+}
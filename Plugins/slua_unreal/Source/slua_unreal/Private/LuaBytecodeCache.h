@@ -0,0 +1,59 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "lua.h"
+
+namespace NS_SLUA {
+
+    typedef TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> LuaBytecodePtr;
+
+    // bytecode of lua source, keyed by hash of source content and loader version,
+    // shared by all states, cached in memory and Saved/LuaBytecode
+    class LuaBytecodeCache {
+    public:
+        // increase it when the way to produce bytecode changed
+        static const uint32 LoaderVersion = 1;
+
+        static bool isEnabled();
+        static bool isStrip();
+
+        // key of source buffer, chunk name only matters if bytecode not stripped
+        static uint64 hash(const uint8* buf, uint32 len, const char* chunk);
+        static LuaBytecodePtr find(uint64 key);
+        static void add(uint64 key, LuaBytecodePtr bytecode);
+        // dump function on top of L to bytecode, strip drops line info
+        static LuaBytecodePtr dump(lua_State* L, bool strip);
+        // bytecode file of Saved/LuaBytecode, null if it isn't compiled from buf by this build
+        static LuaBytecodePtr loadDisk(uint64 key, const uint8* buf, uint32 len);
+        static void saveDisk(uint64 key, const uint8* buf, uint32 len, const TArray<uint8>& bytecode);
+
+        // same as luaL_loadbuffer, but load bytecode from cache if source not changed
+        static int loadBuffer(lua_State* L, const uint8* buf, uint32 len, const char* chunk);
+
+        // record chunk load cost for cold start report
+        enum LoadType {
+            LoadSource,
+            LoadMemoryCache,
+            LoadDiskCache,
+            // bytecode compiled by prefetch worker
+            LoadPrefetch,
+            // bytecode shared by state template
+            LoadTemplate,
+        };
+        static void record(const char* chunk, uint32 size, double seconds, LoadType type);
+        static void report();
+        static void clear();
+    };
+}
@@ -15,13 +15,152 @@
 
 #include "LatentDelegate.h"
 #include "LuaOverrider.h"
+#include "LuaState.h"
+#include "HAL/IConsoleManager.h"
 
 namespace NS_SLUA
 {
+    static int32 CallShapeThunk = 1;
+    FAutoConsoleVariableRef CVarSluaCallShapeThunk(
+        TEXT("slua.CallShapeThunk"),
+        CallShapeThunk,
+        TEXT("Call UFunction of simple signature by specialized thunk.\n"),
+        ECVF_Default);
+
+    static int32 DirectNativeCall = 1;
+    FAutoConsoleVariableRef CVarSluaDirectNativeCall(
+        TEXT("slua.DirectNativeCall"),
+        DirectNativeCall,
+        TEXT("Call native UFunction of plain params by native func ptr with reused param buffer.\n"),
+        ECVF_Default);
+
     TMap<UFunction*, LuaFunctionAccelerator*> LuaFunctionAccelerator::cache;
 
+    namespace {
+        enum ShapeKind : uint32 {
+            ShapeNone,
+            ShapeInt,
+            ShapeFloat,
+            ShapeDouble,
+            ShapeBool,
+            ShapeObject,
+        };
+
+        template<typename T>
+        struct ShapeArg {
+            static const uint32 kind = ShapeNone;
+        };
+
+        template<>
+        struct ShapeArg<void> {
+            static const uint32 kind = ShapeNone;
+            static int push(lua_State* L, uint8* p, NewObjectRecorder* objRecorder) { return 0; }
+        };
+
+        template<typename T, uint32 K>
+        struct ShapeValueArg {
+            static const uint32 kind = K;
+            static void check(lua_State* L, int i, uint8* p, UClass* cls) { *(T*)p = LuaObject::checkValue<T>(L, i); }
+            static int push(lua_State* L, uint8* p, NewObjectRecorder* objRecorder) { return LuaObject::push(L, *(T*)p); }
+        };
+
+        template<> struct ShapeArg<int32> : ShapeValueArg<int32, ShapeInt> {};
+        template<> struct ShapeArg<float> : ShapeValueArg<float, ShapeFloat> {};
+        template<> struct ShapeArg<double> : ShapeValueArg<double, ShapeDouble> {};
+        template<> struct ShapeArg<bool> : ShapeValueArg<bool, ShapeBool> {};
+
+        template<>
+        struct ShapeArg<UObject*> {
+            static const uint32 kind = ShapeObject;
+            // same check as checkUProperty<FObjectProperty>
+            static void check(lua_State* L, int i, uint8* p, UClass* cls) {
+                UObject* arg = LuaObject::checkValue<UObject*>(L, i);
+                if (arg && !LuaObject::isUObjectValid(arg))
+                    luaL_error(L, "arg %d is invalid UObject!", i);
+                if (arg && arg->GetClass() != cls && !arg->GetClass()->IsChildOf(cls))
+                    luaL_error(L, "arg %d expect %s, but got %s", i,
+                        cls ? TCHAR_TO_UTF8(*cls->GetName()) : "",
+                        arg->GetClass() ? TCHAR_TO_UTF8(*arg->GetClass()->GetName()) : "");
+                *(UObject**)p = arg;
+            }
+            static int push(lua_State* L, uint8* p, NewObjectRecorder* objRecorder) {
+                UObject* o = *(UObject**)p;
+                bool ref = objRecorder ? objRecorder->hasObject(o) : false;
+                return LuaObject::push(L, o, ref);
+            }
+        };
+
+        uint32 shapeKindOf(FProperty* prop) {
+            if (prop->IsA<FIntProperty>()) return ShapeInt;
+            if (prop->IsA<FFloatProperty>()) return ShapeFloat;
+            if (prop->IsA<FDoubleProperty>()) return ShapeDouble;
+            if (auto p = CastField<FBoolProperty>(prop)) return p->IsNativeBool() ? ShapeBool : ShapeNone;
+            // soft and weak object property are different types
+            if (prop->GetClass() == FObjectProperty::StaticClass()) return ShapeObject;
+            return ShapeNone;
+        }
+
+        // return kind in low 4 bits, then kind of each arg
+        template<typename R, typename... Args>
+        uint32 shapeKey() {
+            uint32 key = ShapeArg<R>::kind;
+            int n = 0;
+            int dummy[] = { 0, (key |= ShapeArg<Args>::kind << (4 * ++n), 0)... };
+            (void)dummy;
+            (void)n;
+            return key;
+        }
+    }
+
+    template<typename R, typename... Args>
+    struct CallShape {
+        static int call(LuaFunctionAccelerator* acc, lua_State* L, int offset, UObject* obj, NewObjectRecorder* objRecorder) {
+            alignas(16) uint8 params[LuaFunctionAccelerator::ShapeMaxParmsSize];
+            FMemory::Memzero(params, acc->shapeFrameSize);
+            int n = 0;
+            int dummy[] = { 0, (ShapeArg<Args>::check(L, offset + n, params + acc->shapeOffsets[n], acc->shapeClasses[n]), ++n)... };
+            (void)dummy;
+            (void)n;
+            acc->invokeShape(obj, params);
+            return ShapeArg<R>::push(L, params + (ShapeArg<R>::kind ? acc->func->ReturnValueOffset : 0), objRecorder);
+        }
+
+        static void add(TMap<uint32, LuaFunctionAccelerator::ShapeThunk>& thunks) {
+            thunks.Add(shapeKey<R, Args...>(), call);
+        }
+    };
+
+    namespace {
+        template<typename R>
+        void addShapesOfReturn(TMap<uint32, LuaFunctionAccelerator::ShapeThunk>& thunks) {
+            CallShape<R>::add(thunks);
+            CallShape<R, int32>::add(thunks);
+            CallShape<R, float>::add(thunks);
+            CallShape<R, double>::add(thunks);
+            CallShape<R, bool>::add(thunks);
+            CallShape<R, UObject*>::add(thunks);
+            CallShape<R, int32, int32>::add(thunks);
+            CallShape<R, float, float>::add(thunks);
+            CallShape<R, double, double>::add(thunks);
+        }
+
+        TMap<uint32, LuaFunctionAccelerator::ShapeThunk>& shapeThunks() {
+            static TMap<uint32, LuaFunctionAccelerator::ShapeThunk> thunks;
+            if (thunks.Num() == 0) {
+                addShapesOfReturn<void>(thunks);
+                addShapesOfReturn<int32>(thunks);
+                addShapesOfReturn<float>(thunks);
+                addShapesOfReturn<double>(thunks);
+                addShapesOfReturn<bool>(thunks);
+                addShapesOfReturn<UObject*>(thunks);
+            }
+            return thunks;
+        }
+    }
+
     LuaFunctionAccelerator::LuaFunctionAccelerator(UFunction* inFunc)
-        : func(inFunc)
+        : bLuaCallInit(false)
+        , func(inFunc)
         , bLuaOverride(ULuaOverrider::isUFunctionHooked(inFunc))
     {
         auto funcFlag = func->FunctionFlags;
@@ -132,6 +271,213 @@ namespace NS_SLUA
                 }
             }
         }
+
+        initDirectNative();
+        initShape();
+    }
+
+    LuaFunctionAccelerator::~LuaFunctionAccelerator()
+    {
+        if (scratch.params)
+            FMemory::Free(scratch.params);
+    }
+
+    void LuaFunctionAccelerator::initLuaCall()
+    {
+        bLuaCallInit = true;
+        for (TFieldIterator<FProperty> it(func); it && (it->PropertyFlags & CPF_Parm); ++it)
+        {
+            FProperty* prop = *it;
+            uint64 propflag = prop->GetPropertyFlags();
+            if (bNativeFunc ? (propflag & CPF_ReturnParm) != 0 : IsRealOutParam(propflag))
+                continue;
+            bool bOutParm = (propflag & CPF_OutParm) && (propflag & CPF_BlueprintReadOnly);
+            luaCallArgs.Add({ prop->GetOffset_ForInternal(), prop, LuaObject::getPusher(prop), bOutParm });
+        }
+
+        // return value is real out param too, it's checked again if lua returns more values
+        if (bHasReturnParam)
+            luaCallResults.Add({ returnPusherInfo.offset, returnPusherInfo.prop, LuaObject::getChecker(returnPusherInfo.prop) });
+        for (TFieldIterator<FProperty> it(func); it && (it->PropertyFlags & CPF_Parm); ++it)
+        {
+            FProperty* prop = *it;
+            if (IsRealOutParam(prop->GetPropertyFlags()))
+                luaCallResults.Add({ prop->GetOffset_ForInternal(), prop, LuaObject::getChecker(prop) });
+        }
+    }
+
+    void LuaFunctionAccelerator::initDirectNative()
+    {
+        FMemory::Memzero(scratch);
+        bDirectNative = false;
+        if (!bNativeFunc || (func->FunctionFlags & FUNC_Net) || !func->GetNativeFunc())
+            return;
+        // Invoke adjusts object to interface address
+        if (func->GetOuterUClass()->IsChildOf(UInterface::StaticClass()))
+            return;
+
+        for (auto& checkerInfo : paramsChecker)
+        {
+            if (checkerInfo.bLatent)
+                return;
+        }
+        for (TFieldIterator<FProperty> it(func); it && (it->PropertyFlags & CPF_Parm); ++it)
+        {
+            FProperty* prop = *it;
+            if (!prop->HasAllPropertyFlags(CPF_ZeroConstructor | CPF_NoDestructor))
+                return;
+            if (prop->HasAnyPropertyFlags(CPF_OutParm))
+                scratchClears.Add(TPair<int32, int32>(prop->GetOffset_ForInternal(), prop->GetSize()));
+        }
+        bDirectNative = true;
+    }
+
+    void LuaFunctionAccelerator::invokeNative(UObject* obj, FFrame& stack, uint8* returnValueAddress)
+    {
+        stack.CurrentNativeFunction = func;
+        (*func->GetNativeFunc())(obj, stack, returnValueAddress);
+    }
+
+    int LuaFunctionAccelerator::callDirectNative(lua_State* L, int offset, UObject* obj, NewObjectRecorder* objRecorder)
+    {
+        uint32 threadId = FPlatformTLS::GetCurrentThreadId();
+        if (!scratch.params)
+        {
+            // params, then pointers of out params, then out parm list
+            uint32 paramsSize = Align((uint32)func->PropertiesSize, 16);
+            uint32 outParamsSize = func->NumParms * sizeof(PTRINT);
+            uint8* block = (uint8*)FMemory::MallocZeroed(paramsSize + outParamsSize + outParmRecProps.Num() * sizeof(FOutParmRec) + 1, 16);
+            scratch.params = block;
+            scratch.outParams = (PTRINT*)(block + paramsSize);
+            scratch.outParms = outParmRecProps.Num() ? (FOutParmRec*)(block + paramsSize + outParamsSize) : nullptr;
+            for (int32 n = 0; n < outParmRecProps.Num(); n++)
+            {
+                FOutParmRec& out = scratch.outParms[n];
+                out.Property = outParmRecProps[n];
+                out.PropAddr = outParmRecProps[n]->ContainerPtrToValuePtr<uint8>(scratch.params);
+                out.NextOutParm = n + 1 < outParmRecProps.Num() ? &scratch.outParms[n + 1] : nullptr;
+            }
+            scratch.threadId = threadId;
+        }
+        // reentered by native function, or called on another thread
+        if (scratch.bBusy || scratch.threadId != threadId)
+            return -1;
+
+        struct BusyGuard
+        {
+            bool& bBusy;
+            BusyGuard(bool& inBusy) : bBusy(inBusy) { bBusy = true; }
+            ~BusyGuard() { bBusy = false; }
+        } busyGuard(scratch.bBusy);
+
+        uint8* params = scratch.params;
+        PTRINT* outParams = scratch.outParams;
+        for (auto& clear : scratchClears)
+            FMemory::Memzero(params + clear.Key, clear.Value);
+
+        int i = offset;
+        for (auto& checkerInfo : paramsChecker)
+        {
+            if (!checkerInfo.bCheck)
+                continue;
+            auto prop = checkerInfo.prop;
+            PTRINT* pointer = outParams + checkerInfo.index;
+            *pointer = PTRINT(0);
+            // if is out param, can accept nil
+            if (prop->HasAnyPropertyFlags(CPF_OutParm) && lua_isnil(L, i))
+            {
+                i++;
+                continue;
+            }
+            *pointer = PTRINT(checkerInfo.checker(L, prop, params + checkerInfo.offset, i, false));
+            i++;
+        }
+
+        FFrame newStack(obj, func, params, nullptr,
+#if ENGINE_MINOR_VERSION >= 25 || ENGINE_MAJOR_VERSION > 4
+            func->ChildProperties
+#else
+            func->Children
+#endif
+        );
+        newStack.OutParms = scratch.outParms;
+        invokeNative(obj, newStack, bHasReturnParam ? params + func->ReturnValueOffset : nullptr);
+
+        return returnValue(L, offset, params, outParams, objRecorder);
+    }
+
+    void LuaFunctionAccelerator::initShape()
+    {
+        shapeThunk = nullptr;
+        shapeReturnProp = nullptr;
+        // blueprint VM uses the whole frame as locals, not only params
+        shapeFrameSize = bNativeFunc ? func->ParmsSize : func->PropertiesSize;
+        if ((func->FunctionFlags & FUNC_Net) || shapeFrameSize > ShapeMaxParmsSize)
+            return;
+
+        uint32 key = 0;
+        int n = 0;
+        for (TFieldIterator<FProperty> it(func); it && (it->PropertyFlags & CPF_Parm); ++it)
+        {
+            FProperty* prop = *it;
+            uint32 kind = shapeKindOf(prop);
+            if (kind == ShapeNone)
+                return;
+            if (prop->HasAnyPropertyFlags(CPF_ReturnParm))
+            {
+                key |= kind;
+                shapeReturnProp = prop;
+                continue;
+            }
+            if (prop->HasAnyPropertyFlags(CPF_OutParm) || n >= ShapeMaxArgs)
+                return;
+            shapeOffsets[n] = prop->GetOffset_ForInternal();
+            shapeClasses[n] = kind == ShapeObject ? CastField<FObjectProperty>(prop)->PropertyClass : nullptr;
+            key |= kind << (4 * ++n);
+        }
+
+        if (auto thunk = shapeThunks().Find(key))
+            shapeThunk = *thunk;
+    }
+
+    void LuaFunctionAccelerator::invokeShape(UObject* obj, uint8* params)
+    {
+        FFrame newStack(obj, func, params, nullptr,
+#if ENGINE_MINOR_VERSION >= 25 || ENGINE_MAJOR_VERSION > 4
+            func->ChildProperties
+#else
+            func->Children
+#endif
+        );
+
+        uint8* returnValueAddress = nullptr;
+        FOutParmRec returnOut;
+        if (shapeReturnProp)
+        {
+            // script function may write return value through out parm
+            returnValueAddress = params + func->ReturnValueOffset;
+            returnOut.Property = shapeReturnProp;
+            returnOut.PropAddr = returnValueAddress;
+            returnOut.NextOutParm = nullptr;
+            newStack.OutParms = &returnOut;
+        }
+        if (bDirectNative && DirectNativeCall) {
+            invokeNative(obj, newStack, returnValueAddress);
+            return;
+        }
+
+        // same as UObject::ProcessEvent, init and destroy locals of script function
+        if (!bNativeFunc) {
+            for (FProperty* localProp = func->FirstPropertyToInit; localProp; localProp = (FProperty*)localProp->PostConstructLinkNext)
+                localProp->InitializeValue_InContainer(params);
+        }
+        func->Invoke(obj, newStack, returnValueAddress);
+        if (!bNativeFunc) {
+            for (FProperty* destructProp = func->DestructorLink; destructProp; destructProp = destructProp->DestructorLinkNext) {
+                if (!destructProp->IsInContainer(func->ParmsSize))
+                    destructProp->DestroyValue_InContainer(params);
+            }
+        }
     }
 
     LuaFunctionAccelerator* LuaFunctionAccelerator::findOrAdd(UFunction* inFunc)
@@ -179,6 +525,16 @@ namespace NS_SLUA
             return 0;
         }
 
+        if (shapeThunk && CallShapeThunk)
+            return shapeThunk(this, L, offset, obj, objRecorder);
+
+        if (bDirectNative && DirectNativeCall)
+        {
+            int ret = callDirectNative(L, offset, obj, objRecorder);
+            if (ret >= 0)
+                return ret;
+        }
+
         int i = offset;
         uint16 propertiesSize = func->PropertiesSize;
         uint8* params = (uint8*)FMemory_Alloca(propertiesSize);
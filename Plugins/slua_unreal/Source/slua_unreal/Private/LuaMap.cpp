@@ -19,7 +19,7 @@
 #include "LuaReference.h"
 
 #define GET_CHECKER(tag) \
-    auto tag##Checker = LuaObject::getChecker(UD->tag##Prop);\
+    auto tag##Checker = UD->tag##Checker;\
     if (!tag##Checker) { \
         auto tn = UD->tag##Prop->GetClass()->GetName(); \
         luaL_error(L, "unsupport tag type %s to get", TCHAR_TO_UTF8(*tn)); \
@@ -28,8 +28,6 @@
 
 namespace NS_SLUA {
 
-    DefTypeName(LuaMap::Enumerator);
-
     void LuaMap::reg(lua_State* L) {
         SluaUtil::reg(L, "Map", __ctor);
     }
@@ -74,6 +72,7 @@ namespace NS_SLUA {
         , isRef(bIsRef)
         , isNewInner(bIsNewInner)
     {
+        resolveElementFunctions();
         if (!bIsRef) {
             clone(map,kp,vp,buf);
         }
@@ -87,6 +86,7 @@ namespace NS_SLUA {
         , isRef(bIsRef)
         , isNewInner(false)
     {
+        resolveElementFunctions();
         if (!bIsRef) {
             clone(map,keyProp,valueProp,buf);
         }
@@ -153,6 +153,22 @@ namespace NS_SLUA {
         if (rehash) helper.Rehash();
     }
 
+    void LuaMap::resolveElementFunctions() {
+        keyPusher = LuaObject::getPusher(keyProp);
+        valuePusher = LuaObject::getPusher(valueProp);
+        keyChecker = LuaObject::getChecker(keyProp);
+        valueChecker = LuaObject::getChecker(valueProp);
+    }
+
+    int LuaMap::pushKey(lua_State* L, uint8* keyPtr) {
+        // LuaObject::push report unsupported type
+        return keyPusher ? keyPusher(L, keyProp, keyPtr, nullptr) : LuaObject::push(L, keyProp, keyPtr);
+    }
+
+    int LuaMap::pushValue(lua_State* L, uint8* valuePtr) {
+        return valuePusher ? valuePusher(L, valueProp, valuePtr, nullptr) : LuaObject::push(L, valueProp, valuePtr);
+    }
+
     uint8* LuaMap::getKeyPtr(uint8* pairPtr) {
 #if (ENGINE_MINOR_VERSION<22) && (ENGINE_MAJOR_VERSION==4)
         return pairPtr + helper.MapLayout.KeyOffset;
@@ -295,7 +311,7 @@ namespace NS_SLUA {
 
         auto valuePtr = UD->helper.FindValueFromHash(keyPtr);
         if (valuePtr) {
-            LuaObject::push(L, UD->valueProp, valuePtr);
+            UD->pushValue(L, valuePtr);
             LuaObject::push(L, true);
         } else {
             LuaObject::pushNil(L);
@@ -347,39 +363,83 @@ namespace NS_SLUA {
         if (!UD) {
             luaL_error(L, "arg 1 expect LuaMap, but got nil!");
         }
-        auto iter = new LuaMap::Enumerator();
-        iter->map = UD;
-        iter->index = 0;
-        iter->num = UD->helper.Num();
-        lua_pushcfunction(L, LuaMap::Enumerable);
-        LuaObject::pushType(L, iter, "LuaMap::Enumerator", nullptr, LuaMap::Enumerator::gc, 1);
-        // hold referrence of LuaMap, avoid gc
+        // keep map, index and remain count in upvalues, upvalue 1 hold referrence of LuaMap
         lua_pushvalue(L, 1);
-        lua_setuservalue(L, 3);
+        LuaObject::push(L, 0);
+        LuaObject::push(L, UD->helper.Num());
+        lua_pushcclosure(L, LuaMap::Enumerable, 3);
+        LuaObject::pushNil(L);
         LuaObject::pushNil(L);
         return 3;
     }
 
     int LuaMap::Enumerable(lua_State* L) {
-        CheckUD(LuaMap::Enumerator, L, 1);
-        auto map = UD->map;
-        auto& helper = map->helper;
-        do {
-            if (UD->num <= 0) {
-                return 0;
-            } else if (helper.IsValidIndex(UD->index)) {
-                auto pairPtr = helper.GetPairPtr(UD->index);
-                auto keyPtr = map->getKeyPtr(pairPtr);
-                auto valuePtr = map->getValuePtr(pairPtr);
-                LuaObject::push(L, map->keyProp, keyPtr);
-                LuaObject::push(L, map->valueProp, valuePtr);
-                UD->index += 1;
-                UD->num -= 1;
+        CheckUD(LuaMap, L, lua_upvalueindex(1));
+        if (!UD) {
+            return 0;
+        }
+        auto& helper = UD->helper;
+        int32 index = (int32)lua_tointeger(L, lua_upvalueindex(2));
+        int32 remain = (int32)lua_tointeger(L, lua_upvalueindex(3));
+        int32 maxIndex = helper.GetMaxIndex();
+        for (; remain > 0 && index < maxIndex; index++) {
+            if (helper.IsValidIndex(index)) {
+                auto pairPtr = helper.GetPairPtr(index);
+                UD->pushKey(L, UD->getKeyPtr(pairPtr));
+                UD->pushValue(L, UD->getValuePtr(pairPtr));
+                LuaObject::push(L, index + 1);
+                lua_replace(L, lua_upvalueindex(2));
+                LuaObject::push(L, remain - 1);
+                lua_replace(L, lua_upvalueindex(3));
                 return 2;
-            } else {
-                UD->index += 1;
             }
-        } while (true);
+        }
+        return 0;
+    }
+
+    int LuaMap::ToTable(lua_State* L) {
+        CheckUD(LuaMap, L, 1);
+        if (!UD) {
+            luaL_error(L, "arg 1 expect LuaMap, but got nil!");
+        }
+        auto& helper = UD->helper;
+        lua_createtable(L, 0, helper.Num());
+        for (int32 index = 0, maxIndex = helper.GetMaxIndex(); index < maxIndex; index++) {
+            if (helper.IsValidIndex(index)) {
+                auto pairPtr = helper.GetPairPtr(index);
+                UD->pushKey(L, UD->getKeyPtr(pairPtr));
+                UD->pushValue(L, UD->getValuePtr(pairPtr));
+                lua_rawset(L, -3);
+            }
+        }
+        return 1;
+    }
+
+    int LuaMap::FromTable(lua_State* L) {
+        CheckUD(LuaMap, L, 1);
+        if (!UD) {
+            luaL_error(L, "arg 1 expect LuaMap, but got nil!");
+        }
+        luaL_checktype(L, 2, LUA_TTABLE);
+        GET_CHECKER(key);
+        GET_CHECKER(value);
+        UD->clear();
+        // reuse temp key and value for all pairs
+        FDefaultConstructedPropertyElement tempKey(UD->keyProp);
+        FDefaultConstructedPropertyElement tempValue(UD->valueProp);
+        auto keyPtr = tempKey.GetObjAddress();
+        auto valuePtr = tempValue.GetObjAddress();
+        lua_pushnil(L);
+        while (lua_next(L, 2)) {
+            // check a copy of key, checker may convert it in place and break lua_next
+            lua_pushvalue(L, -2);
+            int top = lua_gettop(L);
+            keyChecker(L, UD->keyProp, (uint8*)keyPtr, top, true);
+            valueChecker(L, UD->valueProp, (uint8*)valuePtr, top - 1, true);
+            UD->helper.AddPair(keyPtr, valuePtr);
+            lua_pop(L, 2);
+        }
+        return LuaObject::push(L, UD->num());
     }
 
     int LuaMap::CreateValueTypeObject(lua_State* L) {
@@ -399,12 +459,6 @@ namespace NS_SLUA {
         return 0;
     }
 
-    int LuaMap::Enumerator::gc(lua_State* L) {
-        CheckUD(LuaMap::Enumerator, L, 1);
-        delete UD;
-        return 0;
-    }
-
     int LuaMap::gc(lua_State* L) {
         auto userdata = (UserData<LuaMap*>*)luaL_testudata(L, 1, "LuaMap");
         auto self = userdata->ud;
@@ -427,6 +481,8 @@ namespace NS_SLUA {
         RegMetaMethod(L, Remove);
         RegMetaMethod(L, Clear);
         RegMetaMethod(L, CreateValueTypeObject);
+        RegMetaMethod(L, ToTable);
+        RegMetaMethod(L, FromTable);
 
         RegMetaMethodByName(L, "__pairs", Pairs);
 
@@ -14,6 +14,7 @@
 
 #include "LuaMemoryProfile.h"
 #include "LuaState.h"
+#include "LuaAllocator.h"
 #include "Log.h"
 #include "lstate.h"
 #include "LuaProfiler.h"
@@ -89,9 +90,11 @@ namespace NS_SLUA {
     void* LuaMemoryProfile::alloc (void *ud, void *ptr, size_t osize, size_t nsize) {
         // LLM_SCOPE(ELLMTag::Lua); // For PUBG Mobile
         LuaState* ls = (LuaState*)ud;
+        LuaAllocator* allocator = ls->getAllocator();
         if (nsize == 0) {
             removeRecord(ls, ptr, osize);
-            FMemory::Free(ptr);
+            if (allocator) allocator->realloc(ptr, osize, 0);
+            else FMemory::Free(ptr);
             return NULL;
         }
         else {
@@ -100,7 +103,8 @@ namespace NS_SLUA {
             LuaMemInfo memInfo;
             // get stack before realloc to avoid luaD_reallocstack crash!
             bool bHasStack = getMemInfo(ls, nsize, memInfo);
-            ptr = FMemory::Realloc(ptr,nsize);
+            if (allocator) ptr = allocator->realloc(ptr, osize, nsize);
+            else ptr = FMemory::Realloc(ptr,nsize);
             if (bHasStack)
                 addRecord(ls,ptr,nsize,memInfo);
             return ptr;
@@ -40,6 +40,9 @@
 #include "LuaFunctionAccelerator.h"
 #include "LuaProfiler.h"
 #include "LuaOverrider.h"
+#include "LuaStructPool.h"
+#include "LuaObjectCache.h"
+#include "LuaStaticBinding.h"
 #include "Engine/UserDefinedEnum.h"
 
 static int32 DeferGCStruct = 1;
@@ -55,8 +58,24 @@ FAutoConsoleVariableRef CVarSluaEnableReference(
     GSluaEnableReference,
     TEXT("Whether enable struct reference."));
 
+static int32 AccessorTable = 1;
+FAutoConsoleVariableRef CVarSluaAccessorTable(
+    TEXT("slua.AccessorTable"),
+    AccessorTable,
+    TEXT("Get/set property by per-class accessor table keyed by interned lua string.\n"),
+    ECVF_Default);
+
+static int32 LazyBindType = 0;
+FAutoConsoleVariableRef CVarSluaLazyBindType(
+    TEXT("slua.LazyBindType"),
+    LazyBindType,
+    TEXT("Bind exported types on first access instead of state init, by __index of _G metatable, scripts mustn't replace it.\n"),
+    ECVF_Default);
+
 namespace NS_SLUA {
     static const FName NAME_LatentInfo = TEXT("LatentInfo");
+    // registry key of type name -> bind function not called yet
+    static const char* LazyTypeKey = "__slua_lazytype";
 
     TMap<FFieldClass*,LuaObject::PushPropertyFunction> pusherMap;
     TMap<FFieldClass*,LuaObject::CheckPropertyFunction> checkerMap;
@@ -85,12 +104,48 @@ namespace NS_SLUA {
     TMap< UClass*, TMap<FString, ExtensionField> > extensionMMap;
     TMap< UClass*, TMap<FString, ExtensionField> > extensionMMap_static;
 
+    // extension fields of class and its super flattened on first search,
+    // entries of subclasses removed when extension added since it points into maps above
+    typedef TMap<FName, const ExtensionField*> FlatExtension;
+    TMap<UClass*, FlatExtension> flatExtensionMap;
+    TMap<UClass*, FlatExtension> flatExtensionMap_static;
+
+    const FlatExtension& flattenExtension(UClass* cls, bool isStatic) {
+        auto& flatMap = isStatic ? flatExtensionMap_static : flatExtensionMap;
+        if (auto flat = flatMap.Find(cls))
+            return *flat;
+
+        auto& flat = flatMap.Add(cls);
+        for (UClass* c = cls; c != nullptr; c = c->GetSuperClass()) {
+            auto mapptr = isStatic ? extensionMMap_static.Find(c) : extensionMMap.Find(c);
+            if (!mapptr)
+                continue;
+            // field of subclass first
+            for (auto& pair : *mapptr) {
+                FName key(*pair.Key);
+                if (!flat.Contains(key))
+                    flat.Add(key, &pair.Value);
+            }
+        }
+        return flat;
+    }
+
+    void invalidateExtension(UClass* cls, const char* n, bool isStatic) {
+        auto& flatMap = isStatic ? flatExtensionMap_static : flatExtensionMap;
+        for (auto it = flatMap.CreateIterator(); it; ++it) {
+            if (it.Key()->IsChildOf(cls))
+                it.RemoveCurrent();
+        }
+        LuaState::removeExtensionCache(cls, n);
+    }
+
     namespace ExtensionMethod{
         void init();
     }
 
     LuaStruct::LuaStruct() {
         Init(nullptr, 0, nullptr, false);
+        poolClass = -1;
     }
 
     void LuaStruct::Init(uint8* b, uint32 s, UScriptStruct* u, bool ref) {
@@ -101,7 +156,8 @@ namespace NS_SLUA {
     }
 
     LuaStruct::~LuaStruct() {
-        if (!isRef) {
+        // pooled buffer is released by LuaStructPool
+        if (!isRef && poolClass < 0) {
             if (buf && size > 0) {
                 uss->DestroyStruct(buf);
                 FMemory::Free(buf);
@@ -111,6 +167,10 @@ namespace NS_SLUA {
     }
 
     void LuaStruct::AddReferencedObjects(FReferenceCollector& Collector) {
+        // idle in pool
+        if (!uss)
+            return;
+
         Collector.AddReferencedObject(uss);
         
         if (isRef)
@@ -123,26 +183,23 @@ namespace NS_SLUA {
     }
 
     void LuaObject::addExtensionMethod(UClass* cls,const char* n,lua_CFunction func,bool isStatic) {
-        if(isStatic) {
-            auto& extmap = extensionMMap_static.FindOrAdd(cls);
-            extmap.Add(n, ExtensionField(func));
-        }
-        else {
-            auto& extmap = extensionMMap.FindOrAdd(cls);
-            extmap.Add(n, ExtensionField(func));
-        }
+        auto& extmap = isStatic ? extensionMMap_static.FindOrAdd(cls) : extensionMMap.FindOrAdd(cls);
+        // same binding registered again, e.g. on every state init, keep caches
+        auto field = extmap.Find(n);
+        if (field && field->isFunction && field->func == func)
+            return;
+        invalidateExtension(cls, n, isStatic);
+        extmap.Add(n, ExtensionField(func));
     }
 
     void LuaObject::addExtensionProperty(UClass * cls, const char * n, lua_CFunction getter, lua_CFunction setter, bool isStatic)
     {
-        if (isStatic) {
-            auto& extmap = extensionMMap_static.FindOrAdd(cls);
-            extmap.Add(n, ExtensionField(getter,setter));
-        }
-        else {
-            auto& extmap = extensionMMap.FindOrAdd(cls);
-            extmap.Add(n, ExtensionField(getter, setter));
-        }
+        auto& extmap = isStatic ? extensionMMap_static.FindOrAdd(cls) : extensionMMap.FindOrAdd(cls);
+        auto field = extmap.Find(n);
+        if (field && !field->isFunction && field->getter == getter && field->setter == setter)
+            return;
+        invalidateExtension(cls, n, isStatic);
+        extmap.Add(n, ExtensionField(getter, setter));
     }
 
     static int findMember(lua_State* L,const char* name) {
@@ -168,7 +225,7 @@ namespace NS_SLUA {
                     lua_geti(L,-1,n+1);
                     const char* tn = lua_tostring(L,-1);
                     lua_pop(L,1); // pop tn
-                    luaL_getmetatable(L,tn);
+                    LuaObject::getMetatable(L,tn);
                     luaL_checktype(L, -1, LUA_TTABLE);
                     if (findMember(L, name)) return 1;
                 }
@@ -202,7 +259,7 @@ namespace NS_SLUA {
                     lua_geti(L, -1, n + 1);
                     const char* tn = lua_tostring(L, -1);
                     lua_pop(L, 1); // pop tn
-                    luaL_getmetatable(L, tn);
+                    LuaObject::getMetatable(L, tn);
                     luaL_checktype(L, -1, LUA_TTABLE);
                     if (setMember(L, name)) return true;
                 }
@@ -260,6 +317,88 @@ namespace NS_SLUA {
         setMetaMethods(L);
     }
 
+    // __index of _G, bind lazy type when script access it by name,
+    // upvalue is __index of _G metatable set before us
+    static int lazyGlobalIndex(lua_State* L) {
+        lua_settop(L, 2);
+        if (lua_type(L, 2) == LUA_TSTRING && LuaObject::bindLazyType(L, lua_tostring(L, 2))) {
+            lua_rawget(L, 1);
+            return 1;
+        }
+        switch (lua_type(L, lua_upvalueindex(1))) {
+        case LUA_TFUNCTION:
+            lua_pushvalue(L, lua_upvalueindex(1));
+            lua_insert(L, 1);
+            lua_call(L, 2, 1);
+            return 1;
+        case LUA_TNIL:
+            return 0;
+        default:
+            lua_pushvalue(L, lua_upvalueindex(1));
+            lua_insert(L, 1);
+            lua_gettable(L, 1);
+            return 1;
+        }
+    }
+
+    void LuaObject::regLazyType(lua_State* L, const char* tn, LazyBindFunc bind) {
+        if (!LazyBindType) {
+            bind(L);
+            return;
+        }
+
+        AutoStack as(L);
+        if (lua_getfield(L, LUA_REGISTRYINDEX, LazyTypeKey) != LUA_TTABLE) {
+            lua_pop(L, 1);
+            lua_newtable(L);
+            lua_pushvalue(L, -1);
+            lua_setfield(L, LUA_REGISTRYINDEX, LazyTypeKey);
+
+            // chain to __index of existing metatable, types are still bound on
+            // first push if scripts replace metatable of _G later
+            lua_pushglobaltable(L);
+            if (!lua_getmetatable(L, -1)) {
+                lua_newtable(L);
+                lua_pushvalue(L, -1);
+                lua_setmetatable(L, -3);
+            }
+            lua_getfield(L, -1, "__index");
+            lua_pushcclosure(L, lazyGlobalIndex, 1);
+            lua_setfield(L, -2, "__index");
+            lua_pop(L, 2);
+        }
+        lua_pushlightuserdata(L, (void*)bind);
+        lua_setfield(L, -2, tn);
+    }
+
+    bool LuaObject::bindLazyType(lua_State* L, const char* tn) {
+        if (lua_getfield(L, LUA_REGISTRYINDEX, LazyTypeKey) != LUA_TTABLE) {
+            lua_pop(L, 1);
+            return false;
+        }
+        if (lua_getfield(L, -1, tn) != LUA_TLIGHTUSERDATA) {
+            lua_pop(L, 2);
+            return false;
+        }
+        auto bind = (LazyBindFunc)lua_touserdata(L, -1);
+        lua_pop(L, 1);
+        // remove it first, bind may access type itself
+        lua_pushnil(L);
+        lua_setfield(L, -2, tn);
+        lua_pop(L, 1);
+        bind(L);
+        return true;
+    }
+
+    int LuaObject::getMetatable(lua_State* L, const char* tn) {
+        int t = luaL_getmetatable(L, tn);
+        if (t == LUA_TNIL && bindLazyType(L, tn)) {
+            lua_pop(L, 1);
+            t = luaL_getmetatable(L, tn);
+        }
+        return t;
+    }
+
     void LuaObject::newTypeWithBase(lua_State* L, const char* tn, std::initializer_list<const char*> bases) {
         newType(L,tn);
 
@@ -287,7 +426,7 @@ namespace NS_SLUA {
 
     bool LuaObject::isBaseTypeOf(lua_State* L,const char* tn,const char* base) {
         AutoStack as(L);
-        int t = luaL_getmetatable(L,tn);
+        int t = getMetatable(L,tn);
         if(t!=LUA_TTABLE)
             return false;
 
@@ -587,47 +726,26 @@ namespace NS_SLUA {
         }
     }
 
-    int searchExtensionMethod(lua_State* L,UClass* cls,const char* name,bool isStatic=false) {
-        int ret = 0;
-        // search class and its super
-        while(cls!=nullptr) {
-            TMap<FString,ExtensionField>* mapptr = isStatic?extensionMMap_static.Find(cls):extensionMMap.Find(cls);
-            if(mapptr!=nullptr) {
-                // find field
-                auto fieldptr = mapptr->Find(name);
-                if (fieldptr != nullptr) {
-                    // is function
-                    if (fieldptr->isFunction) {
-                        lua_pushcfunction(L, fieldptr->func);
-                        ret = 1;
-                        break;
-                    } 
-                    // is property
-                    else {
-                        if (!fieldptr->getter) luaL_error(L, "Property %s is set only", name);
-                        lua_pushcfunction(L, fieldptr->getter);
-                        if (!isStatic) {
-                            lua_pushvalue(L, 1); // push self
-                            lua_call(L, 1, 1);
-                        } else 
-                            lua_call(L, 0, 1);
-                        return 1;
-                    }
-                }
-            }
-            cls=cls->GetSuperClass();
-        }
+    int searchExtensionMethod(lua_State* L,UClass* cls,FName fname,const char* name,bool isStatic=false) {
+        auto fieldptr = flattenExtension(cls, isStatic).FindRef(fname);
+        if (fieldptr == nullptr)
+            return 0;
 
-        if (ret)
-        {
+        // is function
+        if (fieldptr->isFunction) {
+            lua_pushcfunction(L, fieldptr->func);
             cacheFunction(L, isStatic ? cls : nullptr);
+            return 1;
         }
-        return ret;
-    }
-
-    int searchExtensionMethod(lua_State* L,UObject* o,const char* name,bool isStatic=false) {
-        auto cls = o->GetClass();
-        return searchExtensionMethod(L,cls,name,isStatic);
+        // is property
+        if (!fieldptr->getter) luaL_error(L, "Property %s is set only", name);
+        lua_pushcfunction(L, fieldptr->getter);
+        if (!isStatic) {
+            lua_pushvalue(L, 1); // push self
+            lua_call(L, 1, 1);
+        } else 
+            lua_call(L, 0, 1);
+        return 1;
     }
 
     int classIndex(lua_State* L) {
@@ -643,23 +761,32 @@ namespace NS_SLUA {
         const char* name = lua_tostring(L, 2);
 
         // get blueprint member
-        UFunction* func = cls->FindFunctionByName(ANSI_TO_TCHAR(name));
+        FName wname(ANSI_TO_TCHAR(name));
+        UFunction* func = cls->FindFunctionByName(wname);
         if (func) {
             return LuaObject::push(L, func, cls);
         }
-        return searchExtensionMethod(L,cls,name,true);
+        return searchExtensionMethod(L,cls,wname,name,true);
+    }
+
+    LuaStruct* LuaObject::newStruct(lua_State* L, UScriptStruct* uss) {
+        if (auto ls = LuaState::get(L)->structPool->acquire(uss))
+            return ls;
+
+        uint32 size = uss->GetStructureSize() ? uss->GetStructureSize() : 1;
+        uint8* buf = (uint8*)FMemory::Malloc(size);
+        uss->InitializeStruct(buf);
+        LuaStruct* ls = new LuaStruct();
+        ls->Init(buf, size, uss, false);
+        return ls;
     }
 
     int structConstruct(lua_State* L) {
         UScriptStruct* uss = LuaObject::checkValue<UScriptStruct*>(L, 1);
         if(uss) {
-            uint32 size = uss->GetStructureSize() ? uss->GetStructureSize() : 1;
-            uint8* buf = (uint8*)FMemory::Malloc(size);
-            uss->InitializeStruct(buf);
-            LuaStruct* ls = new LuaStruct();
-            ls->Init(buf, size, uss, false);
+            LuaStruct* ls = LuaObject::newStruct(L, uss);
             LuaObject::push(L,ls);
-            LuaObject::addLink(L,buf);
+            LuaObject::addLink(L,ls->buf);
             return 1;
         }
         return 0;
@@ -779,6 +906,119 @@ namespace NS_SLUA {
         return state->classMap.findProp(cls, pname);
     }
 
+    // misses kept per accessor table
+    const int32 MaxAccessorMisses = 1024;
+
+    const LuaPropAccessor* LuaObject::findAccessor(lua_State* L, UStruct* cls, int keyIndex)
+    {
+        // only short strings are interned, long name goes old path
+        TValue* key = getTValue(L, keyIndex);
+        if (!ttisshrstring(key)) return nullptr;
+        const void* ks = tsvalue(key);
+
+        auto state = LuaState::get(L);
+        auto& cache = state->classMap;
+        auto table = cache.lastAccessorStruct == cls ? cache.lastAccessorTable : cache.accessorMap.Find(cls);
+        if (!table) {
+            table = &cache.accessorMap.Add(cls);
+        }
+        cache.lastAccessorStruct = cls;
+        cache.lastAccessorTable = table;
+
+        if (auto slot = table->index.Find(ks))
+            return &table->slots[*slot];
+        // dynamic keys may be anything, only a false miss is possible if hash equals
+        uint32 hash = tsvalue(key)->hash;
+        if (auto miss = table->misses.Find(ks)) {
+            if (*miss == hash)
+                return nullptr;
+        }
+
+        FProperty* prop = findCacheProperty(L, cls, lua_tostring(L, keyIndex));
+        if (!prop) {
+            // dynamic keys are unbounded, drop all misses rather than grow with the state
+            if (table->misses.Num() >= MaxAccessorMisses)
+                table->misses.Reset();
+            table->misses.Add(ks, hash);
+            return nullptr;
+        }
+        table->misses.Remove(ks);
+
+        // anchor property name, address of a collected string may be reused by another one,
+        // names of properties are a fixed set, so anchor table won't grow with dynamic keys
+        lua_geti(L, LUA_REGISTRYINDEX, state->accessorKeyRef);
+        lua_pushvalue(L, keyIndex);
+        lua_pushboolean(L, 1);
+        lua_rawset(L, -3);
+        lua_pop(L, 1);
+
+        static const uint64 ReferenceCastFlags = FArrayProperty::StaticClassCastFlags()
+            | FMapProperty::StaticClassCastFlags()
+            | FSetProperty::StaticClassCastFlags();
+
+        LuaPropAccessor accessor;
+        accessor.prop = prop;
+        accessor.owner = cls;
+        accessor.offset = prop->GetOffset_ForInternal();
+        accessor.flags = 0;
+        accessor.pusher = getPusher(prop);
+        accessor.checker = getChecker(prop);
+        accessor.getter = nullptr;
+        accessor.setter = nullptr;
+        // same lookup order as objectIndex, static binding first
+        if (UClass* uclass = Cast<UClass>(cls)) {
+            auto binding = LuaStaticBinding::find(uclass, lua_tostring(L, keyIndex));
+            if (binding && !binding->func) {
+                accessor.getter = binding->getter;
+                accessor.setter = binding->setter;
+            }
+        }
+        if (prop->GetPropertyFlags() & CPF_BlueprintReadOnly)
+            accessor.flags |= LuaPropAccessor::ReadOnly;
+#if (ENGINE_MINOR_VERSION<25) && (ENGINE_MAJOR_VERSION==4)
+        bool useReference = GSluaEnableReference || prop->GetClass()->HasAnyCastFlag(ReferenceCastFlags);
+#else
+        bool useReference = GSluaEnableReference || prop->HasAnyCastFlags(ReferenceCastFlags);
+#endif
+        if (useReference && getReferencePusher(prop))
+            accessor.flags |= LuaPropAccessor::Reference;
+        int32 slot = table->slots.Add(accessor);
+#if defined(LUA_INLINE_CACHE)
+        // slots may be reallocated, accessors cached by vm are invalid
+        lua_resetinlinecache(L);
+#endif
+        table->index.Add(ks, slot);
+        return &table->slots[slot];
+    }
+
+    int LuaObject::accessorIndex(lua_State* L, UStruct* cls, uint8* parent)
+    {
+        auto accessor = findAccessor(L, cls, 2);
+        if (!accessor)
+            return 0;
+        if (accessor->getter && LuaStaticBinding::isEnabled())
+            return accessor->getter(L, (UObject*)parent);
+        if (!accessor->pusher || (accessor->flags & LuaPropAccessor::Reference))
+            return 0;
+        return accessor->pusher(L, accessor->prop, parent + accessor->offset, nullptr);
+    }
+
+    bool LuaObject::accessorNewIndex(lua_State* L, UStruct* cls, uint8* parent)
+    {
+        auto accessor = findAccessor(L, cls, 2);
+        if (!accessor)
+            return false;
+        if (accessor->setter && LuaStaticBinding::isEnabled()) {
+            accessor->setter(L, (UObject*)parent, 3);
+            return true;
+        }
+        // readonly error is raised by old path
+        if (!accessor->checker || (accessor->flags & LuaPropAccessor::ReadOnly))
+            return false;
+        accessor->checker(L, accessor->prop, parent + accessor->offset, 3, true);
+        return true;
+    }
+
     int luaFuncClosure(lua_State* L) {
         int argsCount = lua_gettop(L);
         lua_pushvalue(L, lua_upvalueindex(1));
@@ -1012,6 +1252,10 @@ namespace NS_SLUA {
 
     int instanceIndex(lua_State* L) {
         UObject* obj = LuaObject::checkValue<UObject*>(L, 1);
+        if (AccessorTable && obj) {
+            if (int res = LuaObject::accessorIndex(L, obj->GetClass(), (uint8*)obj))
+                return res;
+        }
         if (int res = LuaObject::fastIndex(L, (uint8*)obj))
         {
             return res;
@@ -1093,6 +1337,11 @@ namespace NS_SLUA {
 
     int LuaObject::objectIndex(lua_State* L, UObject* obj, const char* name, bool cacheToLua) {
         UClass* cls = obj->GetClass();
+        // self table passed by overrider is left to reflection path
+        auto binding = lua_type(L, 1) == LUA_TUSERDATA ? LuaStaticBinding::find(cls, name) : nullptr;
+        // property is searched before lua table member, as reflected property below
+        if (binding && !binding->func)
+            return binding->getter(L, obj);
         FProperty* up = LuaObject::findCacheProperty(L, cls, name);
         if (up)
         {
@@ -1130,12 +1379,21 @@ namespace NS_SLUA {
             #pragma warning(pop)
         }
 
+        // method of lua table shadows the bound one, as it does UFunction
+        if (binding) {
+            if (int res = tryGetTableMember(L, obj))
+                return res;
+            lua_pushcfunction(L, binding->func);
+            cacheFunction(L, nullptr);
+            return 1;
+        }
+
         // get blueprint member
         FName wname(ANSI_TO_TCHAR(name));
         UFunction* func = cls->FindFunctionByName(wname);
         if (!func) {
             // search extension method
-            return searchExtensionMethod(L, obj, name);
+            return searchExtensionMethod(L, cls, wname, name);
         }
         else {
             if (!(func->FunctionFlags & FUNC_Net))
@@ -1171,6 +1429,12 @@ namespace NS_SLUA {
     bool LuaObject::objectNewIndex(lua_State* L, UObject* obj, const char* name, int valueIdx, bool checkValid)
     {
         UClass* cls = obj->GetClass();
+        // only property has setter, it's set before lua table member as reflected property
+        auto binding = lua_type(L, 1) == LUA_TUSERDATA ? LuaStaticBinding::find(cls, name) : nullptr;
+        if (binding && binding->setter) {
+            binding->setter(L, obj, valueIdx);
+            return true;
+        }
         FProperty* up = findCacheProperty(L, cls, name);
         if (!up) {
             if (checkValid)
@@ -1193,6 +1457,10 @@ namespace NS_SLUA {
 
     int newinstanceIndex(lua_State* L) {
         UObject* obj = LuaObject::checkValue<UObject*>(L, 1);
+        if (AccessorTable && obj && LuaObject::accessorNewIndex(L, obj->GetClass(), (uint8*)obj))
+        {
+            return 0;
+        }
         if (LuaObject::fastNewIndex(L, (uint8*)obj))
         {
             return 0;
@@ -1255,6 +1523,10 @@ namespace NS_SLUA {
 
     int instanceStructIndex(lua_State* L) {
         LuaStruct* ls = LuaObject::checkValue<LuaStruct*>(L, 1);
+        if (AccessorTable) {
+            if (int res = LuaObject::accessorIndex(L, ls->uss, ls->buf))
+                return res;
+        }
         if (int res = LuaObject::fastIndex(L, ls->buf))
         {
             return res;
@@ -1292,6 +1564,10 @@ namespace NS_SLUA {
 
     int newinstanceStructIndex(lua_State* L) {
         LuaStruct* ls = LuaObject::checkValue<LuaStruct*>(L, 1);
+        if (AccessorTable && LuaObject::accessorNewIndex(L, ls->uss, ls->buf))
+        {
+            return 0;
+        }
         if (LuaObject::fastNewIndex(L, ls->buf))
         {
             return 0;
@@ -1312,6 +1588,124 @@ namespace NS_SLUA {
         return 0;
     }
 
+#if defined(LUA_INLINE_CACHE)
+    // memory of the instance if accessor belongs to its type, or nullptr to go old path
+    static uint8* inlineCacheParent(void* u, const LuaPropAccessor* accessor) {
+        auto ud = (GenericUserData*)u;
+        if (ud->flag & (UD_HADFREE | UD_WEAKUPTR))
+            return nullptr;
+        if (ud->flag & UD_UOBJECT) {
+            auto obj = (UObject*)ud->ud;
+            if (!LuaObject::isUObjectValid(obj) || obj->GetClass() != accessor->owner)
+                return nullptr;
+            return (uint8*)obj;
+        }
+        if (ud->flag & UD_USTRUCT) {
+            auto ls = (LuaStruct*)ud->ud;
+            return ls->uss == accessor->owner ? ls->buf : nullptr;
+        }
+        return nullptr;
+    }
+
+    static int inlineCacheResolve(lua_State* L, int uidx, int kidx, int isset, void** data) {
+        *data = nullptr;
+        if (!lua_getmetatable(L, uidx))
+            return 1;
+        lua_pushstring(L, isset ? "__newindex" : "__index");
+        lua_rawget(L, -2);
+        lua_CFunction f = lua_tocfunction(L, -1);
+        lua_pop(L, 2);
+
+        // only instances exported by slua, same metatable same decision
+        bool isObject = f == (isset ? newinstanceIndex : instanceIndex);
+        bool isStruct = f == (isset ? newinstanceStructIndex : instanceStructIndex);
+        if (!AccessorTable || (!isObject && !isStruct))
+            return 1;
+
+        auto ud = (GenericUserData*)lua_touserdata(L, uidx);
+        if (ud->flag & (UD_HADFREE | UD_WEAKUPTR))
+            return 0;
+        UStruct* cls = nullptr;
+        if (isObject && (ud->flag & UD_UOBJECT)) {
+            auto obj = (UObject*)ud->ud;
+            if (!LuaObject::isUObjectValid(obj))
+                return 0;
+            cls = obj->GetClass();
+        }
+        else if (isStruct && (ud->flag & UD_USTRUCT))
+            cls = ((LuaStruct*)ud->ud)->uss;
+        else
+            return 0;
+
+        auto accessor = LuaObject::findAccessor(L, cls, kidx);
+        if (!accessor)
+            return 1;
+        if (isset ? (accessor->setter || (accessor->checker && !(accessor->flags & LuaPropAccessor::ReadOnly)))
+            : (accessor->getter || (accessor->pusher && !(accessor->flags & LuaPropAccessor::Reference))))
+            *data = (void*)accessor;
+        return 1;
+    }
+
+    static int inlineCacheGet(lua_State* L, void* u, void* data) {
+        auto accessor = (const LuaPropAccessor*)data;
+        uint8* parent = inlineCacheParent(u, accessor);
+        if (!parent)
+            return 0;
+        if (accessor->getter && LuaStaticBinding::isEnabled())
+            return accessor->getter(L, (UObject*)parent);
+        // binding turned off, reference property goes old path
+        if (!accessor->pusher || (accessor->flags & LuaPropAccessor::Reference))
+            return 0;
+        return accessor->pusher(L, accessor->prop, parent + accessor->offset, nullptr);
+    }
+
+    static int inlineCacheSet(lua_State* L, void* u, void* data, int vidx) {
+        auto accessor = (const LuaPropAccessor*)data;
+        uint8* parent = inlineCacheParent(u, accessor);
+        if (!parent)
+            return 0;
+        if (accessor->setter && LuaStaticBinding::isEnabled()) {
+            accessor->setter(L, (UObject*)parent, vidx);
+            return 1;
+        }
+        if (!accessor->checker || (accessor->flags & LuaPropAccessor::ReadOnly))
+            return 0;
+        accessor->checker(L, accessor->prop, parent + accessor->offset, vidx, true);
+        return 1;
+    }
+#endif
+
+    void LuaObject::setInlineCache(lua_State* L, bool enable) {
+#if defined(LUA_INLINE_CACHE)
+        if (enable)
+            lua_setinlinecache(L, inlineCacheResolve, inlineCacheGet, inlineCacheSet);
+        else
+            lua_setinlinecache(L, nullptr, nullptr, nullptr);
+#endif
+    }
+
+    void LuaObject::objectCacheFnzHook(lua_State* L, void* u, lua_CFunction gc) {
+        LuaObjectCache* objCache = LuaState::get(L)->objCache;
+        // only userdata with our __gc is GenericUserData
+        auto ud = (GenericUserData*)u;
+        if (!objCache || ud->flag & UD_HADFREE)
+            return;
+        UObject* obj = nullptr;
+        if (gc == gcObject || gc == gcClass || gc == gcStructClass)
+            obj = (UObject*)ud->ud;
+        else if (gc == gcWeakUObject)
+            // pending kill object is still cached, entry should be removed with its userdata
+            obj = ((WeakUObjectUD*)ud->ud)->getEvenIfPendingKill();
+        if (obj)
+            objCache->remove(GUObjectArray.ObjectToIndex(obj), ud);
+    }
+
+    void LuaObject::setObjectCache(lua_State* L, bool enable) {
+#if defined(LUA_FNZ_HOOK)
+        lua_setfnzhook(L, enable ? objectCacheFnzHook : nullptr);
+#endif
+    }
+
     FString getPropertyFriendlyName(FProperty* prop) {
         if (prop->IsNative()) {
             return prop->GetName();
@@ -1432,7 +1826,7 @@ namespace NS_SLUA {
 
     void LuaObject::setupMetaTable(lua_State* L, const char* tn, lua_CFunction gc)
     {
-        luaL_getmetatable(L, tn);
+        getMetatable(L, tn);
         if (lua_isnil(L, -1))
             luaL_error(L, "Can't find type %s exported", tn);
 
@@ -1708,7 +2102,7 @@ namespace NS_SLUA {
         SimpleString str(TCHAR_TO_ANSI(*uss->GetStructCPPName()));
         const char* tname = str.c_str();
 
-        luaL_getmetatable(L,tname);
+        LuaObject::getMetatable(L,tname);
         if (!lua_isnil(L, -1)) {
             auto ud = lua_newuserdata(L, sizeof(GenericUserData));
             if (!ud) luaL_error(L, "out of memory to new ud");
@@ -1747,15 +2141,10 @@ namespace NS_SLUA {
             return 1;
         }
 
-        uint32 size = uss->GetStructureSize() ? uss->GetStructureSize() : 1;
-        uint8* buf = (uint8*)FMemory::Malloc(size);
-        uss->InitializeStruct(buf);
-        uss->CopyScriptStruct(buf, parms);
-        
-        LuaStruct* ls = new LuaStruct();
-        ls->Init(buf, size, uss, false);
+        LuaStruct* ls = LuaObject::newStruct(L, uss);
+        uss->CopyScriptStruct(ls->buf, parms);
         int ret = LuaObject::push(L, ls);
-        LuaObject::addLink(L,buf);
+        LuaObject::addLink(L,ls->buf);
         return ret;
     }  
 
@@ -2007,6 +2396,31 @@ namespace NS_SLUA {
         return true;
     }
 
+    bool LuaObject::getObjCache(lua_State* L, UObject* obj, const char* tn) {
+        LuaObjectCache* objCache = LuaState::get(L)->objCache;
+        if (!objCache)
+            return getObjCache(L, (void*)obj, tn);
+#if defined(LUA_FNZ_HOOK)
+        void* ud = objCache->find(obj);
+        if (!ud)
+            return false;
+        // userdata is alive, entry removed before it's finalized
+        lua_pushnil(L);
+        setuvalue(L, L->top - 1, (Udata*)((char*)ud - sizeof(UUdata)));
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void LuaObject::cacheObj(lua_State* L, UObject* obj) {
+        LuaObjectCache* objCache = LuaState::get(L)->objCache;
+        if (objCache)
+            objCache->add(obj, lua_touserdata(L, -1));
+        else
+            cacheObj(L, (void*)obj);
+    }
+
     void LuaObject::addRef(lua_State* L,UObject* obj,void* ud,bool ref) {
         auto sl = LuaState::get(L);
         sl->addRef(obj,ud,ref);
@@ -2082,6 +2496,32 @@ namespace NS_SLUA {
         lua_pop(L, 1); // pop cache table
     }
 
+    void LuaObject::removeExtensionIndex(UClass* cls)
+    {
+        if (flatExtensionMap.Num() > 0)
+            flatExtensionMap.Remove(cls);
+        if (flatExtensionMap_static.Num() > 0)
+            flatExtensionMap_static.Remove(cls);
+    }
+
+    void LuaObject::removeExtensionCache(lua_State* L, UClass* cls, const char* name)
+    {
+        // static fields cached in uservalue of class userdata are kept
+        auto ls = LuaState::get(L);
+        lua_geti(L, LUA_REGISTRYINDEX, ls->cacheClassFuncRef);
+        lua_pushnil(L);
+        while (lua_next(L, -2) != 0) {
+            auto c = (UClass*)lua_touserdata(L, -2);
+            if (c && c->IsChildOf(cls) && lua_istable(L, -1)) {
+                lua_pushstring(L, name);
+                lua_pushnil(L);
+                lua_rawset(L, -3);
+            }
+            lua_pop(L, 1);
+        }
+        lua_pop(L, 1);
+    }
+
     void LuaObject::removeCache(lua_State* L, const void* obj, int ref)
     {
         // get cache table
@@ -2197,14 +2637,14 @@ namespace NS_SLUA {
             unlinkProp(L, userdata);
         }
 
+        LuaState* luaState = LuaState::get(L);
         if (DeferGCStruct)
         {
-            LuaState* luaState = LuaState::get(L);
             luaState->deferGCStruct.Add(ls);
         }
         else
         {
-            delete ls;
+            luaState->structPool->release(ls);
         }
 
         return 0;
@@ -0,0 +1,112 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "LuaObjectCache.h"
+#include "Log.h"
+#include "lua.h"
+#include "UObject/UObjectArray.h"
+#include "HAL/IConsoleManager.h"
+
+namespace NS_SLUA {
+
+    static int32 NativeObjectCache = 1;
+    FAutoConsoleVariableRef CVarSluaNativeObjectCache(
+        TEXT("slua.NativeObjectCache"),
+        NativeObjectCache,
+        TEXT("Cache pushed UObject of new lua state by object index instead of weak table.\n"),
+        ECVF_Default);
+
+    LuaObjectCache::LuaObjectCache()
+    {
+        FMemory::Memzero(stats);
+    }
+
+    LuaObjectCache::~LuaObjectCache()
+    {
+        for (auto page : pages)
+            FMemory::Free(page);
+        pages.Empty();
+    }
+
+    bool LuaObjectCache::isEnabled()
+    {
+#if defined(LUA_FNZ_HOOK)
+        return !!NativeObjectCache;
+#else
+        // can't know when userdata is going to be finalized
+        return false;
+#endif
+    }
+
+    void* LuaObjectCache::find(const UObjectBase* obj)
+    {
+        int32 index = GUObjectArray.ObjectToIndex(obj);
+        int32 page = index >> PageBits;
+        Entry* entry = page < pages.Num() && pages[page] ? &pages[page][index & (PageSize - 1)] : nullptr;
+        if (!entry || !entry->ud) {
+            stats.misses++;
+            return nullptr;
+        }
+        // index reused by another object
+        auto item = GUObjectArray.IndexToObject(index);
+        if (!item || item->GetSerialNumber() != entry->serial) {
+            remove(index);
+            stats.misses++;
+            return nullptr;
+        }
+        stats.hits++;
+        return entry->ud;
+    }
+
+    void LuaObjectCache::add(const UObjectBase* obj, void* ud)
+    {
+        int32 index = GUObjectArray.ObjectToIndex(obj);
+        int32 page = index >> PageBits;
+        if (page >= pages.Num())
+            pages.AddZeroed(page + 1 - pages.Num());
+        if (!pages[page]) {
+            pages[page] = (Entry*)FMemory::MallocZeroed(sizeof(Entry) * PageSize);
+            stats.pages++;
+        }
+        Entry& entry = pages[page][index & (PageSize - 1)];
+        if (!entry.ud) {
+            stats.live++;
+            stats.maxLive = FMath::Max(stats.maxLive, stats.live);
+        }
+        entry.serial = GUObjectArray.AllocateSerialNumber(index);
+        entry.ud = ud;
+        stats.adds++;
+    }
+
+    void LuaObjectCache::remove(int32 index, void* ud)
+    {
+        int32 page = index >> PageBits;
+        if (index < 0 || page >= pages.Num() || !pages[page])
+            return;
+        Entry& entry = pages[page][index & (PageSize - 1)];
+        if (!entry.ud || (ud && entry.ud != ud))
+            return;
+        entry.ud = nullptr;
+        stats.live--;
+        stats.removes++;
+    }
+
+    void LuaObjectCache::dumpStats() const
+    {
+        uint64 total = stats.hits + stats.misses;
+        Log::Log("Lua object cache hits %llu, misses %llu (%.1f%% hit), adds %llu, removes %llu",
+            stats.hits, stats.misses, total ? stats.hits * 100.0 / total : 0.0, stats.adds, stats.removes);
+        Log::Log("Lua object cache live %d (max %d), pages %d (%d kb)",
+            stats.live, stats.maxLive, stats.pages, stats.pages * (int32)(sizeof(Entry) * PageSize / 1024));
+    }
+}
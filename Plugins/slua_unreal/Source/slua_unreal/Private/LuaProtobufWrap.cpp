@@ -20,19 +20,37 @@ namespace NS_SLUA {
 
     namespace LuaProtobuf {
 
-        void init(lua_State *L) {
-            luaL_requiref(L, "pb", luaopen_pb, 0);
-            lua_pop(L, 1);
-            
+        // pb shares slice and buffer metatables, open them together
+        static int openPb(lua_State *L) {
             luaL_requiref(L, "pb.slice", luaopen_pb_slice, 0);
             lua_pop(L, 1);
-            
+
             luaL_requiref(L, "pb.buffer", luaopen_pb_buffer, 0);
             lua_pop(L, 1);
-            
+
             luaL_requiref(L, "pb.conv", luaopen_pb_conv, 0);
             lua_pop(L, 1);
 
+            return luaopen_pb(L);
+        }
+
+        void init(lua_State *L) {
+            // opened on first require
+            static const luaL_Reg preload[] = {
+                { "pb", openPb },
+                { "pb.slice", luaopen_pb_slice },
+                { "pb.buffer", luaopen_pb_buffer },
+                { "pb.conv", luaopen_pb_conv },
+                { NULL, NULL }
+            };
+
+            lua_getglobal(L, "package");
+            lua_getfield(L, -1, "preload");
+            for (auto lib = preload; lib->func; lib++) {
+                lua_pushcfunction(L, lib->func);
+                lua_setfield(L, -2, lib->name);
+            }
+            lua_pop(L, 2);
         }
     }
 }
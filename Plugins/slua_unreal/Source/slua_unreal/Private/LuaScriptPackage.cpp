@@ -0,0 +1,295 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "LuaScriptPackage.h"
+#include "LuaState.h"
+#include "LuaBytecodeCache.h"
+#include "Log.h"
+#include "lua.h"
+#include "lauxlib.h"
+#include "Hash/CityHash.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeRWLock.h"
+#if !((ENGINE_MINOR_VERSION<20) && (ENGINE_MAJOR_VERSION==4))
+#include "Async/MappedFileHandle.h"
+#define SLUA_MAPPED_FILE 1
+#else
+#define SLUA_MAPPED_FILE 0
+#endif
+
+namespace NS_SLUA {
+
+    namespace {
+        typedef TSharedPtr<LuaScriptPackage, ESPMode::ThreadSafe> PackagePtr;
+        // read by prefetch threads, written by mount/unmount on game thread
+        TArray<PackagePtr> Packages;
+        FRWLock PackagesLock;
+
+        struct BuildItem {
+            TArray<ANSICHAR> name;
+            uint64 nameHash;
+            uint32 flags;
+            TArray<uint8> data;
+        };
+    }
+
+    uint64 LuaScriptPackage::hashName(const char* name, uint32 len)
+    {
+        return CityHash64(name, len);
+    }
+
+    bool LuaScriptPackage::build(const FString& dir, const FString& outFile, bool compile)
+    {
+        TArray<FString> files;
+        IFileManager::Get().FindFilesRecursive(files, *dir, TEXT("*.lua"), true, false);
+
+        FString root = dir / TEXT("");
+        TArray<BuildItem> items;
+        for (auto& file : files) {
+            BuildItem item;
+            if (!FFileHelper::LoadFileToArray(item.data, *file)) {
+                Log::Error("Can't read lua file %s", TCHAR_TO_UTF8(*file));
+                return false;
+            }
+
+            FString relative = file;
+            FPaths::MakePathRelativeTo(relative, *root);
+            FString module = FPaths::ChangeExtension(relative, TEXT("")).Replace(TEXT("/"), TEXT("."));
+            FTCHARToUTF8 utf8(*module);
+            item.name.Append(utf8.Get(), utf8.Length());
+            item.nameHash = hashName(item.name.GetData(), item.name.Num());
+            item.flags = 0;
+
+            if (compile) {
+                char chunk[256];
+                snprintf(chunk, 256, "@%s", TCHAR_TO_UTF8(*relative));
+                lua_State* L = luaL_newstate();
+                if (luaL_loadbuffer(L, (const char*)item.data.GetData(), item.data.Num(), chunk) != 0) {
+                    Log::Error("Compile %s failed: %s", TCHAR_TO_UTF8(*file), lua_tostring(L, -1));
+                    lua_close(L);
+                    return false;
+                }
+                auto bytecode = LuaBytecodeCache::dump(L, LuaBytecodeCache::isStrip());
+                lua_close(L);
+                if (!bytecode.IsValid()) {
+                    Log::Error("Dump %s failed", TCHAR_TO_UTF8(*file));
+                    return false;
+                }
+                item.data = *bytecode;
+                item.flags |= EntryBytecode;
+            }
+            items.Add(MoveTemp(item));
+        }
+
+        items.Sort([](const BuildItem& a, const BuildItem& b) { return a.nameHash < b.nameHash; });
+
+        uint32 nameOffset = sizeof(Header) + sizeof(Entry) * items.Num();
+        uint32 dataOffset = nameOffset;
+        for (auto& item : items)
+            dataOffset += item.name.Num();
+
+        TArray<uint8> out;
+        Header header = { Magic, Version, (uint32)items.Num(), 0 };
+        out.Append((const uint8*)&header, sizeof(header));
+        for (auto& item : items) {
+            Entry entry;
+            FMemory::Memzero(entry);
+            entry.nameHash = item.nameHash;
+            entry.nameOffset = nameOffset;
+            entry.nameSize = item.name.Num();
+            entry.dataOffset = dataOffset;
+            entry.dataSize = item.data.Num();
+            entry.flags = item.flags;
+            out.Append((const uint8*)&entry, sizeof(entry));
+            nameOffset += entry.nameSize;
+            dataOffset += entry.dataSize;
+        }
+        for (auto& item : items)
+            out.Append((const uint8*)item.name.GetData(), item.name.Num());
+        for (auto& item : items)
+            out.Append(item.data);
+
+        if (!FFileHelper::SaveArrayToFile(out, *outFile)) {
+            Log::Error("Can't write lua package %s", TCHAR_TO_UTF8(*outFile));
+            return false;
+        }
+        Log::Log("Build lua package %s, %d modules, %d bytes", TCHAR_TO_UTF8(*outFile), items.Num(), out.Num());
+        return true;
+    }
+
+    LuaScriptPackage::LuaScriptPackage()
+        : mappedHandle(nullptr)
+        , mappedRegion(nullptr)
+        , base(nullptr)
+        , size(0)
+        , header(nullptr)
+        , entries(nullptr)
+    {
+    }
+
+    LuaScriptPackage::~LuaScriptPackage()
+    {
+#if SLUA_MAPPED_FILE
+        delete mappedRegion;
+        delete mappedHandle;
+#endif
+    }
+
+    bool LuaScriptPackage::open(const FString& file)
+    {
+        fileName = file;
+#if SLUA_MAPPED_FILE
+        mappedHandle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*file);
+        if (mappedHandle) {
+            mappedRegion = mappedHandle->MapRegion(0, mappedHandle->GetFileSize());
+            if (mappedRegion) {
+                base = mappedRegion->GetMappedPtr();
+                size = mappedRegion->GetMappedSize();
+            }
+        }
+#endif
+        // platform doesn't support mapping, read it once
+        if (!base) {
+            if (!FFileHelper::LoadFileToArray(fileData, *file))
+                return false;
+            base = fileData.GetData();
+            size = fileData.Num();
+        }
+
+        if (size < sizeof(Header))
+            return false;
+        header = (const Header*)base;
+        if (header->magic != Magic || header->version != Version)
+            return false;
+        if (sizeof(Header) + (uint64)sizeof(Entry) * header->count > size)
+            return false;
+        entries = (const Entry*)(base + sizeof(Header));
+        for (uint32 i = 0; i < header->count; i++) {
+            auto& entry = entries[i];
+            if ((uint64)entry.nameOffset + entry.nameSize > size || (uint64)entry.dataOffset + entry.dataSize > size)
+                return false;
+        }
+        return true;
+    }
+
+    bool LuaScriptPackage::mount(const FString& file)
+    {
+        auto package = new LuaScriptPackage();
+        if (!package->open(file)) {
+            Log::Error("Mount lua package %s failed", TCHAR_TO_UTF8(*file));
+            delete package;
+            return false;
+        }
+        FRWScopeLock lock(PackagesLock, SLT_Write);
+        Packages.Insert(PackagePtr(package), 0);
+        return true;
+    }
+
+    void LuaScriptPackage::unmountAll()
+    {
+        // package is freed when the last span borrowing it released
+        FRWScopeLock lock(PackagesLock, SLT_Write);
+        Packages.Empty();
+    }
+
+    bool LuaScriptPackage::isMounted()
+    {
+        FRWScopeLock lock(PackagesLock, SLT_ReadOnly);
+        return Packages.Num() > 0;
+    }
+
+    const LuaScriptPackage::Entry* LuaScriptPackage::findEntry(const char* module) const
+    {
+        uint32 len = strlen(module);
+        uint64 nameHash = hashName(module, len);
+        // lower bound of nameHash
+        uint32 lo = 0, hi = header->count;
+        while (lo < hi) {
+            uint32 mid = (lo + hi) / 2;
+            if (entries[mid].nameHash < nameHash) lo = mid + 1;
+            else hi = mid;
+        }
+        for (; lo < header->count && entries[lo].nameHash == nameHash; lo++) {
+            auto& entry = entries[lo];
+            if (entry.nameSize == len && FMemory::Memcmp(base + entry.nameOffset, module, len) == 0)
+                return &entry;
+        }
+        return nullptr;
+    }
+
+    TSharedPtr<LuaScriptPackage, ESPMode::ThreadSafe> LuaScriptPackage::findPackage(const char* module, const uint8*& data, uint32& dataSize, FString& filepath)
+    {
+        FRWScopeLock lock(PackagesLock, SLT_ReadOnly);
+        for (auto& package : Packages) {
+            if (auto entry = package->findEntry(module)) {
+                data = package->base + entry->dataOffset;
+                dataSize = entry->dataSize;
+                filepath = package->fileName / FString(UTF8_TO_TCHAR(module)).Replace(TEXT("."), TEXT("/")) + TEXT(".lua");
+                return package;
+            }
+        }
+        return nullptr;
+    }
+
+    bool LuaScriptPackage::find(const char* module, const uint8*& data, uint32& dataSize, FString& filepath)
+    {
+        return findPackage(module, data, dataSize, filepath).IsValid();
+    }
+
+    TArray<uint8> LuaScriptPackage::loadFile(const char* fn, FString& filepath)
+    {
+        const uint8* data;
+        uint32 dataSize;
+        // hold package while copying, unmount may run on other thread
+        if (auto package = findPackage(fn, data, dataSize, filepath))
+            return TArray<uint8>(data, dataSize);
+        return TArray<uint8>();
+    }
+
+    static void releasePackage(void* ud)
+    {
+        delete (PackagePtr*)ud;
+    }
+
+    bool LuaScriptPackage::loadFileSpan(const char* fn, FString& filepath, LuaFileSpan& span)
+    {
+        auto package = findPackage(fn, span.data, span.size, filepath);
+        if (!package.IsValid())
+            return false;
+        // span keeps package mapped until released, even if unmounted meanwhile
+        span.release = releasePackage;
+        span.ud = new PackagePtr(package);
+        return true;
+    }
+
+    static void buildScriptPackage(const TArray<FString>& args) {
+        if (args.Num() < 2) {
+            Log::Log("Usage: slua.BuildScriptPackage <lua dir> <output file> [compile]");
+            return;
+        }
+        FString dir = FPaths::IsRelative(args[0]) ? FPaths::ProjectContentDir() / args[0] : args[0];
+        FString out = FPaths::IsRelative(args[1]) ? FPaths::ProjectContentDir() / args[1] : args[1];
+        bool compile = args.Num() > 2 && FCString::Atoi(*args[2]) != 0;
+        LuaScriptPackage::build(dir, out, compile);
+    }
+
+    static FAutoConsoleCommand CVarBuildScriptPackage(
+        TEXT("slua.BuildScriptPackage"),
+        TEXT("Pack lua files under dir to one package, dir and output relative to Content"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(buildScriptPackage),
+        ECVF_Cheat);
+}
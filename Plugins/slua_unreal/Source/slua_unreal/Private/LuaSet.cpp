@@ -5,7 +5,7 @@
 #include "LuaReference.h"
 
 #define GET_SET_CHECKER() \
-    const auto ElementChecker = LuaObject::getChecker(UD->InElementProperty);\
+    const auto ElementChecker = UD->ElementChecker;\
     if (!ElementChecker) { \
         const auto tn = UD->InElementProperty->GetClass()->GetName(); \
         luaL_error(L, "Nonsupport type %s", TCHAR_TO_UTF8(*tn)); \
@@ -15,14 +15,14 @@
 namespace NS_SLUA
 {
 
-    DefTypeName(LuaSet::Enumerator);
-
     LuaSet::LuaSet(FProperty* Property, FScriptSet* Buffer, bool bIsRef, bool bIsNewInner)
         : Set(bIsRef ? Buffer : new FScriptSet())
         , InElementProperty(Property)
         , Helper(FScriptSetHelper::CreateHelperFormElementProperty(InElementProperty, Set))
         , IsRef(bIsRef)
         , isNewInner(bIsNewInner)
+        , ElementPusher(LuaObject::getPusher(Property))
+        , ElementChecker(LuaObject::getChecker(Property))
     {
         if (!IsRef)
         {
@@ -36,6 +36,8 @@ namespace NS_SLUA
         , Helper(FScriptSetHelper::CreateHelperFormElementProperty(InElementProperty, Set))
         , IsRef(bIsRef)
         , isNewInner(false)
+        , ElementPusher(LuaObject::getPusher(Property->ElementProp))
+        , ElementChecker(LuaObject::getChecker(Property->ElementProp))
     {
         if (!IsRef)
         {
@@ -140,7 +142,7 @@ namespace NS_SLUA
         const auto Index = UD->Helper.FindElementIndexFromHash(ElementPtr);
         if (Index != INDEX_NONE)
         {
-            LuaObject::push(L, UD->InElementProperty, UD->Helper.GetElementPtr(Index));
+            UD->pushElement(L, UD->Helper.GetElementPtr(Index));
             LuaObject::push(L, true);
         }
         else
@@ -194,43 +196,76 @@ namespace NS_SLUA
         if (!UD) {
             luaL_error(L, "arg 1 expect LuaSet, but got nil!");
         }
-        Enumerator* Iter = new Enumerator();
-
-        Iter->Set = UD;
-        Iter->Index = 0;
-        Iter->Num = UD->Helper.Num();
-
+        // Stateless iterator, the control variable is the sparse index of element
         lua_pushcfunction(L, LuaSet::Enumerable);
-        LuaObject::pushType(L, Iter, "LuaSet::Enumerator", nullptr, Enumerator::gc);
-        // Hold reference of LuaSet, avoiding GC
         lua_pushvalue(L, 1);
-        lua_setuservalue(L, 3);
-        LuaObject::pushNil(L);
+        LuaObject::push(L, -1);
         return 3;
     }
 
     int LuaSet::Enumerable(lua_State* L)
     {
-        CheckUD(LuaSet::Enumerator, L, 1);
-        LuaSet* Set = UD->Set;
-        FScriptSetHelper& Helper = Set->Helper;
-
-        while (UD->Num > 0)
+        CheckUD(LuaSet, L, 1);
+        if (!UD) {
+            return 0;
+        }
+        FScriptSetHelper& Helper = UD->Helper;
+        const int32 MaxIndex = Helper.GetMaxIndex();
+        for (int32 Index = (int32)luaL_checkinteger(L, 2) + 1; Index < MaxIndex; Index++)
         {
-            if (Helper.IsValidIndex(UD->Index))
+            if (Helper.IsValidIndex(Index))
             {
-                const auto ElementPtr = Helper.GetElementPtr(UD->Index);
-                LuaObject::push(L, UD->Index);
-                LuaObject::push(L, Set->InElementProperty, ElementPtr);
-                UD->Index += 1;
-                UD->Num -= 1;
+                LuaObject::push(L, Index);
+                UD->pushElement(L, Helper.GetElementPtr(Index));
                 return 2;
             }
-            UD->Index += 1;
         }
         return 0;
     }
 
+    int LuaSet::ToTable(lua_State* L)
+    {
+        CheckUD(LuaSet, L, 1);
+        if (!UD) {
+            luaL_error(L, "arg 1 expect LuaSet, but got nil!");
+        }
+        FScriptSetHelper& Helper = UD->Helper;
+        lua_createtable(L, Helper.Num(), 0);
+        int32 N = 0;
+        for (int32 Index = 0, MaxIndex = Helper.GetMaxIndex(); Index < MaxIndex; Index++)
+        {
+            if (Helper.IsValidIndex(Index))
+            {
+                UD->pushElement(L, Helper.GetElementPtr(Index));
+                lua_rawseti(L, -2, ++N);
+            }
+        }
+        return 1;
+    }
+
+    int LuaSet::FromTable(lua_State* L)
+    {
+        CheckUD(LuaSet, L, 1);
+        if (!UD) {
+            luaL_error(L, "arg 1 expect LuaSet, but got nil!");
+        }
+        luaL_checktype(L, 2, LUA_TTABLE);
+        GET_SET_CHECKER();
+        UD->clear();
+        // Reuse temp element for all elements
+        const FDefaultConstructedPropertyElement tempElement(UD->InElementProperty);
+        const auto ElementPtr = tempElement.GetObjAddress();
+        const int32 N = (int32)lua_rawlen(L, 2);
+        for (int32 i = 1; i <= N; i++)
+        {
+            lua_rawgeti(L, 2, i);
+            ElementChecker(L, UD->InElementProperty, static_cast<uint8*>(ElementPtr), lua_gettop(L), true);
+            UD->Helper.AddElement(ElementPtr);
+            lua_pop(L, 1);
+        }
+        return LuaObject::push(L, UD->num());
+    }
+
     int LuaSet::CreateElementTypeObject(lua_State* L)
     {
         CheckUD(LuaSet, L, 1);
@@ -282,6 +317,12 @@ namespace NS_SLUA
         return Helper.Num();
     }
 
+    int LuaSet::pushElement(lua_State* L, uint8* ElementPtr)
+    {
+        // LuaObject::push report unsupported type
+        return ElementPusher ? ElementPusher(L, InElementProperty, ElementPtr, nullptr) : LuaObject::push(L, InElementProperty, ElementPtr);
+    }
+
     void LuaSet::clear()
     {
         if (!InElementProperty)
@@ -361,6 +402,8 @@ namespace NS_SLUA
         RegMetaMethod(L, Clear);
         RegMetaMethod(L, Pairs);
         RegMetaMethod(L, CreateElementTypeObject);
+        RegMetaMethod(L, ToTable);
+        RegMetaMethod(L, FromTable);
         
         RegMetaMethodByName(L, "__pairs", Pairs);
         return 0;
@@ -378,11 +421,4 @@ namespace NS_SLUA
         delete userdata->ud;
         return 0;
     }
-
-    int LuaSet::Enumerator::gc(lua_State* L)
-    {
-        CheckUD(LuaSet::Enumerator, L, 1);
-        delete UD;
-        return 0;
-    }
 }
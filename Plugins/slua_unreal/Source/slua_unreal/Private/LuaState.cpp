@@ -23,6 +23,9 @@
 #include "Blueprint/UserWidget.h"
 #include "Misc/AssertionMacros.h"
 #include "Misc/SecureHash.h"
+#include "Misc/App.h"
+#include "Async/Async.h"
+#include "Async/Future.h"
 #include "Log.h"
 #include "lua.h"
 #include "lualib.h"
@@ -30,10 +33,17 @@
 #include "LuaArray.h"
 #include "LuaMap.h"
 #include "LuaSet.h"
+#include "LuaArrayView.h"
 #include "LuaMemoryProfile.h"
+#include "LuaAllocator.h"
+#include "LuaStructPool.h"
+#include "LuaObjectCache.h"
+#include "LuaBytecodeCache.h"
+#include "LuaScriptPackage.h"
 #include "HAL/RunnableThread.h"
 #include "LatentDelegate.h"
 #include "LuaFunctionAccelerator.h"
+#include "LuaStaticBinding.h"
 #include "LuaOverrider.h"
 #include "LuaOverriderInterface.h"
 #include "LuaProfiler.h"
@@ -44,8 +54,10 @@
 namespace NS_SLUA {
     FLuaStateInitEvent LuaState::onInitEvent;
     
-    const int MaxLuaExecTime = 60; // in second
     const int MaxLuaGCCount = 8192;
+    // same as lua default gcpause and gcstepmul
+    const int DefaultGCPause = 200;
+    const int DefaultGCStepMul = 200;
 
     static float GCStructTimeLimit = 0.001f;
 
@@ -54,6 +66,78 @@ namespace NS_SLUA {
         GCStructTimeLimit,
         TEXT("Defer gc struct time limit in one frame.\n"),
         ECVF_Default);
+
+    static int32 AsyncFreeStruct = 1;
+
+    FAutoConsoleVariableRef CVarSluaAsyncFreeStruct(
+        TEXT("slua.AsyncFreeStruct"),
+        AsyncFreeStruct,
+        TEXT("Free plain old data struct buffer of defer gc struct on worker thread.\n"),
+        ECVF_Default);
+
+    static int32 SizeClassAlloc = 0;
+
+    FAutoConsoleVariableRef CVarSluaSizeClassAlloc(
+        TEXT("slua.SizeClassAlloc"),
+        SizeClassAlloc,
+        TEXT("Use size class allocator for new lua state.\n"),
+        ECVF_Default);
+
+    static int32 ScriptWatchdog = 1;
+
+    FAutoConsoleVariableRef CVarSluaScriptWatchdog(
+        TEXT("slua.ScriptWatchdog"),
+        ScriptWatchdog,
+        TEXT("Watch long running script calls of new lua state, not available in shipping.\n"),
+        ECVF_Default);
+
+    static float ScriptWarnThresholdMs = 100.0f;
+
+    FAutoConsoleVariableRef CVarSluaScriptWarnThresholdMs(
+        TEXT("slua.ScriptWarnThresholdMs"),
+        ScriptWarnThresholdMs,
+        TEXT("Script call longer than this is sampled and recorded by call site.\n"),
+        ECVF_Default);
+
+    static float ScriptTimeoutSeconds = 60.0f;
+
+    FAutoConsoleVariableRef CVarSluaScriptTimeoutSeconds(
+        TEXT("slua.ScriptTimeoutSeconds"),
+        ScriptTimeoutSeconds,
+        TEXT("Raise error in script call running longer than this.\n"),
+        ECVF_Default);
+
+    static int32 ScriptWatchdogIntervalMs = 10;
+
+    FAutoConsoleVariableRef CVarSluaScriptWatchdogIntervalMs(
+        TEXT("slua.ScriptWatchdogIntervalMs"),
+        ScriptWatchdogIntervalMs,
+        TEXT("Sample interval of script watchdog thread.\n"),
+        ECVF_Default);
+
+    static void onInlineCacheChanged(IConsoleVariable* var);
+    static int32 InlineCache = 1;
+    FAutoConsoleVariableRef CVarSluaInlineCache(
+        TEXT("slua.InlineCache"),
+        InlineCache,
+        TEXT("Cache property accessor at lua field access sites, applied to all states.\n"),
+        FConsoleVariableDelegate::CreateStatic(onInlineCacheChanged),
+        ECVF_Default);
+
+    // "source:linedefined" of lua function, site is a lua closure from scriptSite
+    static FString callSiteName(const void* site) {
+        if (!site) return TEXT("?");
+        const Proto* p = ((const LClosure*)site)->p;
+        if (!p->source) return FString::Printf(TEXT("?:%d"), p->linedefined);
+        const char* source = getstr(p->source);
+        if (*source == '@' || *source == '=') source++;
+        return FString::Printf(TEXT("%s:%d"), UTF8_TO_TCHAR(source), p->linedefined);
+    }
+
+    // less than this count, free struct buffer on game thread
+    const int MinAsyncFreeStructCount = 16;
+    // buffers waiting for free on worker thread of all states
+    static FThreadSafeCounter AsyncFreeStructPending;
     
     int print(lua_State *L) {
         FString str;
@@ -83,6 +167,34 @@ namespace NS_SLUA {
         else Log::Error("%s", err);
     }
 
+    int LuaState::refValue(lua_State* l) {
+        int ref;
+        // nil is never stored, same as luaL_ref
+        if (freeRefs.Num() > 0 && !lua_isnil(l, -1)) {
+            ref = freeRefs.Pop(false);
+            lua_rawseti(l, LUA_REGISTRYINDEX, ref);
+        }
+        else
+            ref = luaL_ref(l, LUA_REGISTRYINDEX);
+#if UE_BUILD_DEVELOPMENT
+        addRefTraceback(ref);
+#endif
+        return ref;
+    }
+
+    void LuaState::unrefValue(int ref) {
+        if (ref == LUA_NOREF || ref == LUA_REFNIL)
+            return;
+        // keep slot for next refValue instead of luaL_unref,
+        // fill it with false so the registry array keeps no holes for luaL_ref's border
+        lua_pushboolean(L, 0);
+        lua_rawseti(L, LUA_REGISTRYINDEX, ref);
+        freeRefs.Add(ref);
+#if UE_BUILD_DEVELOPMENT
+        removeRefTraceback(ref);
+#endif
+    }
+
     int newCacheTable(lua_State* L) {
         lua_newtable(L);
         lua_newtable(L);
@@ -128,15 +240,53 @@ namespace NS_SLUA {
         return newObjectsInCallStack[stackLayer].Contains(const_cast<UObject*>(obj));
     }
 
+    static bool loadModuleBytecode(lua_State* L, const FString& filepath, const TArray<uint8>& bytecode,
+        double start, LuaBytecodeCache::LoadType type) {
+        char chunk[256];
+        snprintf(chunk,256,"@%s",TCHAR_TO_UTF8(*filepath));
+        if (luaL_loadbufferx(L, (const char*)bytecode.GetData(), bytecode.Num(), chunk, "b") == 0) {
+            LuaBytecodeCache::record(chunk, bytecode.Num(), FPlatformTime::Seconds() - start, type);
+            return true;
+        }
+        Log::Error("%s", lua_tostring(L, -1));
+        lua_pop(L, 1);
+        return false;
+    }
+
     int LuaState::loader(lua_State* L) {
         LuaState* state = LuaState::get(L);
         const char* fn = lua_tostring(L,1);
+        FString module = UTF8_TO_TCHAR(fn);
+        bool required = false;
+        state->requiredModuleSet.Add(module, &required);
+        if (!required)
+            state->requiredModules.Add(module);
+
+        if (auto future = state->prefetchMap.Find(module)) {
+            double start = FPlatformTime::Seconds();
+            // wait if worker not finished, it's what we do anyway if not prefetched
+            PrefetchResult result = future->Get();
+            state->prefetchMap.Remove(module);
+            if (result.bytecode.IsValid()
+                && loadModuleBytecode(L, result.filepath, *result.bytecode, start, LuaBytecodeCache::LoadPrefetch))
+                return 1;
+        }
+
+        if (state->stateTemplate.IsValid()) {
+            if (auto index = state->stateTemplate->moduleIndex.Find(module)) {
+                auto& m = state->stateTemplate->modules[*index];
+                if (m.bytecode.IsValid()
+                    && loadModuleBytecode(L, m.filepath, *m.bytecode, FPlatformTime::Seconds(), LuaBytecodeCache::LoadTemplate))
+                    return 1;
+            }
+        }
+
         FString filepath;
-        TArray<uint8> buf = state->loadFile(fn, filepath);
-        if(buf.Num() > 0) {
+        LuaFileSpan span;
+        if(loadFileSpan(state->loadFileSpanDelegate, state->loadFileDelegate, fn, filepath, span)) {
             char chunk[256];
             snprintf(chunk,256,"@%s",TCHAR_TO_UTF8(*filepath));
-            if(luaL_loadbuffer(L,(const char*)buf.GetData(),buf.Num(),chunk)==0) {
+            if(LuaBytecodeCache::loadBuffer(L,span.data,span.size,chunk)==0) {
                 return 1;
             }
             else {
@@ -155,6 +305,118 @@ namespace NS_SLUA {
         return TArray<uint8>();
     }
 
+    static void releaseFileArray(void* ud) {
+        delete (TArray<uint8>*)ud;
+    }
+
+    bool LuaState::loadFileSpan(LoadFileSpanDelegate spanDelegate, LoadFileDelegate delegate,
+        const char* fn, FString& filepath, LuaFileSpan& span) {
+        // mounted package is searched first, load from mapped memory without copy
+        if (LuaScriptPackage::isMounted() && LuaScriptPackage::loadFileSpan(fn, filepath, span))
+            return true;
+        if (spanDelegate && spanDelegate(fn, filepath, span) && span.size > 0)
+            return true;
+        span.reset();
+        if (delegate) {
+            // adapter of old delegate, move the array to heap and free it on release
+            auto buf = new TArray<uint8>(delegate(fn, filepath));
+            if (buf->Num() > 0) {
+                span.data = buf->GetData();
+                span.size = buf->Num();
+                span.release = releaseFileArray;
+                span.ud = buf;
+                return true;
+            }
+            delete buf;
+        }
+        return false;
+    }
+
+    void LuaState::prefetchModules(const TArray<FString>& modules) {
+        if (!loadFileDelegate && !loadFileSpanDelegate && !LuaScriptPackage::isMounted()) return;
+        auto spanDelegate = loadFileSpanDelegate;
+        auto delegate = loadFileDelegate;
+        for (auto& module : modules) {
+            if (prefetchMap.Contains(module)) continue;
+            // already loaded, require won't call loader again
+            lua_getfield(L, LUA_REGISTRYINDEX, LUA_LOADED_TABLE);
+            bool loaded = lua_getfield(L, -1, TCHAR_TO_UTF8(*module)) != LUA_TNIL;
+            lua_pop(L, 2);
+            if (loaded) continue;
+
+            prefetchMap.Add(module, Async(EAsyncExecution::ThreadPool, [spanDelegate, delegate, module]() {
+                return prefetchModule(spanDelegate, delegate, module);
+            }));
+        }
+    }
+
+    LuaState::PrefetchResult LuaState::prefetchModule(LoadFileSpanDelegate spanDelegate, LoadFileDelegate delegate, const FString& module) {
+        PrefetchResult result;
+        LuaFileSpan buf;
+        // empty file is left to loader on main state
+        if (!loadFileSpan(spanDelegate, delegate, TCHAR_TO_UTF8(*module), result.filepath, buf) || buf.size == 0)
+            return result;
+
+        // precompiled file, nothing to do
+        if (buf.data[0] == LUA_SIGNATURE[0]) {
+            result.bytecode = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(buf.data, buf.size);
+            return result;
+        }
+
+        char chunk[256];
+        snprintf(chunk,256,"@%s",TCHAR_TO_UTF8(*result.filepath));
+        bool cache = LuaBytecodeCache::isEnabled();
+        uint64 key = 0;
+        if (cache) {
+            key = LuaBytecodeCache::hash(buf.data, buf.size, chunk);
+            result.bytecode = LuaBytecodeCache::find(key);
+            if (result.bytecode.IsValid()) return result;
+        }
+
+        // compile in a scratch state, only bytecode survive
+        double start = FPlatformTime::Seconds();
+        lua_State* scratch = luaL_newstate();
+        if (luaL_loadbuffer(scratch, (const char*)buf.data, buf.size, chunk) == 0) {
+            // without cache bytecode only carries chunk to main state, keep line info
+            result.bytecode = LuaBytecodeCache::dump(scratch, cache && LuaBytecodeCache::isStrip());
+            if (result.bytecode.IsValid() && cache)
+                LuaBytecodeCache::add(key, result.bytecode);
+            LuaBytecodeCache::record(chunk, buf.size, FPlatformTime::Seconds() - start, LuaBytecodeCache::LoadSource);
+        }
+        // leave syntax error to loader on main state
+        lua_close(scratch);
+        return result;
+    }
+
+    LuaState::TemplatePtr LuaState::makeTemplate() const {
+        auto tmpl = MakeShared<Template, ESPMode::ThreadSafe>();
+        tmpl->loadFileDelegate = loadFileDelegate;
+        tmpl->loadFileSpanDelegate = loadFileSpanDelegate;
+        for (auto& module : requiredModules) {
+            // compile again instead of dump loaded function, upvalues of main chunk are gone
+            PrefetchResult result = prefetchModule(loadFileSpanDelegate, loadFileDelegate, module);
+            tmpl->moduleIndex.Add(module, tmpl->modules.Num());
+            tmpl->modules.Add({ module, result.filepath, result.bytecode });
+        }
+        return tmpl;
+    }
+
+    bool LuaState::initFromTemplate(TemplatePtr tmpl) {
+        if (!tmpl.IsValid())
+            return init();
+
+        loadFileDelegate = tmpl->loadFileDelegate;
+        loadFileSpanDelegate = tmpl->loadFileSpanDelegate;
+        if (!init())
+            return false;
+
+        stateTemplate = tmpl;
+        // nested modules are loaded by their parent, require skips them
+        for (auto& m : tmpl->modules)
+            requireModule(TCHAR_TO_UTF8(*m.name));
+        return true;
+    }
+
     int LuaState::import(lua_State *L) {
         const char* name = LuaObject::checkValue<const char*>(L, 1);
         if (name) {
@@ -239,13 +501,28 @@ namespace NS_SLUA {
     TMap<int,LuaState*> stateMapFromIndex;
     static int StateIndex = 0;
 
+    static void onInlineCacheChanged(IConsoleVariable* var) {
+        for (auto& pair : stateMapFromIndex)
+            LuaObject::setInlineCache(pair.Value->getLuaState(), !!InlineCache);
+    }
+
+    void LuaState::removeExtensionCache(UClass* cls, const char* name) {
+        for (auto& pair : stateMapFromIndex)
+            LuaObject::removeExtensionCache(pair.Value->getLuaState(), cls, name);
+    }
+
     LuaState::LuaState(const char* name, UGameInstance* gameInstance)
         : loadFileDelegate(nullptr)
+        , loadFileSpanDelegate(nullptr)
         , L(nullptr)
+        , allocator(nullptr)
+        , structPool(nullptr)
+        , objCache(nullptr)
         , cacheObjRef(LUA_NOREF)
         , cacheEnumRef(LUA_NOREF)
         , cacheClassPropRef(LUA_NOREF)
         , cacheClassFuncRef(LUA_NOREF)
+        , accessorKeyRef(LUA_NOREF)
         , si(0)
         , deadLoopCheck(nullptr)
         , overrider(nullptr)
@@ -253,6 +530,14 @@ namespace NS_SLUA {
         , stepGCCountLimit(0)
         , fullGCInterval(0.0)
         , lastFullGCSeconds(0.0)
+        , innerAlloc(nullptr)
+        , innerAllocUD(nullptr)
+        , allocatedBytes(0)
+        , lastAllocatedBytes(0)
+        , gcPacerBudget(0.0)
+        , gcPacerFrameTime(0.0)
+        , gcPacerTargetKB(0)
+        , gcPacerCostPerKB(0.0)
         , latentDelegate(nullptr)
         , currentCallStack(0)
     {
@@ -344,7 +629,10 @@ namespace NS_SLUA {
     }
 
     void LuaState::tickGC(float dtime) {
-        if (stepGCTimeLimit > 0.0) {
+        if (gcPacerBudget > 0.0) {
+            tickGCPacer(dtime);
+        }
+        else if (stepGCTimeLimit > 0.0) {
             QUICK_SCOPE_CYCLE_COUNTER(Lua_StepGC)
 #if !UE_BUILD_SHIPPING
             PROFILER_WATCHER_X(stepGC, "StepGC");
@@ -399,25 +687,160 @@ namespace NS_SLUA {
             }
         }
 
+        tickDeferGCStruct();
+    }
+
+    void LuaState::tickDeferGCStruct() {
+        QUICK_SCOPE_CYCLE_COUNTER(Lua_DeferGCStruct)
+        deferGCStructStats.maxBacklog = FMath::Max(deferGCStructStats.maxBacklog, deferGCStruct.Num());
+
+        TArray<void*> freeBuffers;
+        double start = FPlatformTime::Seconds();
+        for (int count = 1; deferGCStruct.Num() > 0; count++)
         {
-            QUICK_SCOPE_CYCLE_COUNTER(Lua_DeferGCStruct)
-            double stepCost = 0.0;
-            for (double start = FPlatformTime::Seconds(), now = start; now - start + stepCost < GCStructTimeLimit;)
+            // order doesn't matter, pop from tail to avoid moving elements
+            auto luaStruct = deferGCStruct.Pop(false);
+            // plain old data has trivial destructor and no UObject reference,
+            // only memory free left, so it's safe to free buffer on worker thread
+            // LuaStruct itself is FGCObject, must be deleted on game thread
+            // pooled buffer is recycled with LuaStruct
+            if (AsyncFreeStruct && !luaStruct->isRef && luaStruct->poolClass < 0 && luaStruct->buf && luaStruct->size > 0
+                && (luaStruct->uss->StructFlags & STRUCT_IsPlainOldData)) {
+                freeBuffers.Add(luaStruct->buf);
+                luaStruct->buf = nullptr;
+            }
+            else {
+                deferGCStructStats.gameThreadFreed++;
+            }
+            structPool->release(luaStruct);
+
+            // check time every few structs, FPlatformTime::Seconds isn't free
+            if ((count & 15) == 0 && FPlatformTime::Seconds() - start > GCStructTimeLimit)
+                break;
+        }
+
+        if (freeBuffers.Num() >= MinAsyncFreeStructCount) {
+            deferGCStructStats.workerFreed += freeBuffers.Num();
+            AsyncFreeStructPending.Add(freeBuffers.Num());
+            AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [buffers = MoveTemp(freeBuffers)]()
             {
-                if (deferGCStruct.Num() == 0)
-                {
-                    break;
-                }
+                for (auto buf : buffers)
+                    FMemory::Free(buf);
+                AsyncFreeStructPending.Subtract(buffers.Num());
+            });
+        }
+        else {
+            // too few to pay for a task
+            deferGCStructStats.gameThreadFreed += freeBuffers.Num();
+            for (auto buf : freeBuffers)
+                FMemory::Free(buf);
+        }
+        deferGCStructStats.backlog = deferGCStruct.Num();
+        deferGCStructStats.workerPending = AsyncFreeStructPending.GetValue();
+    }
+
+    void* LuaState::countAlloc(void* ud, void* ptr, size_t osize, size_t nsize) {
+        auto ls = (LuaState*)ud;
+        // when ptr is null, osize is the object type, not a size
+        if (!ptr)
+            ls->allocatedBytes += nsize;
+        else if (nsize > osize)
+            ls->allocatedBytes += nsize - osize;
+        return ls->innerAlloc(ls->innerAllocUD, ptr, osize, nsize);
+    }
+
+    void LuaState::tickGCPacer(float dtime) {
+        QUICK_SCOPE_CYCLE_COUNTER(Lua_GCPacer)
+#if !UE_BUILD_SHIPPING
+        PROFILER_WATCHER_X(stepGC, "StepGC");
+#endif
+        global_State* g = L->l_G;
+        double start = FPlatformTime::Seconds();
+
+        // allocation since last frame
+        uint64 allocated = allocatedBytes - lastAllocatedBytes;
+        lastAllocatedBytes = allocatedBytes;
+        if (dtime > 0.0f)
+            gcPacerStats.allocRate = gcPacerStats.allocRate * 0.9 + (allocated / dtime) * 0.1;
+
+        int heapKB = lua_gc(L, LUA_GCCOUNT, 0);
+        double pressure = gcPacerTargetKB > 0 ? (double)heapKB / gcPacerTargetKB : 1.0;
+
+        // start next cycle earlier and collect harder when heap get close to target
+        int pause = FMath::Clamp((int)(100 + 100 * (1.0 - pressure)), 100, 200);
+        int stepmul = FMath::Clamp((int)(200 * pressure), 100, 1000);
+        if (pause != gcPacerStats.pause) lua_gc(L, LUA_GCSETPAUSE, pause);
+        if (stepmul != gcPacerStats.stepmul) lua_gc(L, LUA_GCSETSTEPMUL, stepmul);
+        gcPacerStats.pause = pause;
+        gcPacerStats.stepmul = stepmul;
+
+        double budget = gcPacerBudget;
+        if (gcPacerFrameTime > 0.0 && pressure < 1.0 && !FApp::UseFixedTimeStep()) {
+            // spend less when this frame is already long, but keep a quarter to keep up with allocation
+            double left = gcPacerFrameTime - (start - FApp::GetCurrentTime());
+            budget = FMath::Clamp(left, budget * 0.25, budget);
+        }
+        gcPacerStats.budget = budget;
+        gcPacerStats.frames++;
+
+        // nothing to collect, let heap grow until target
+        bool idle = g->gcstate == GCSpause && pressure < 1.0;
+        bool fullGCExpired = fullGCInterval > 0.0 && start - lastFullGCSeconds > fullGCInterval;
+        if (idle && !fullGCExpired) {
+            gcPacerStats.heapKB = heapKB;
+            gcPacerStats.lastCost = 0.0;
+            return;
+        }
+
+        // collector should run faster than mutator, over target we use all budget
+        double needKB = pressure < 1.0 ? FMath::Max(1.0, allocated / 1024.0 * stepmul / 100.0) : DBL_MAX;
+        double doneKB = 0.0;
+        double now = start;
+        while (doneKB < needKB) {
+            // each step cost about a quarter of budget
+            int stepKB = gcPacerCostPerKB > 0.0 ? (int)(budget * 0.25 / gcPacerCostPerKB) : 1;
+            stepKB = FMath::Clamp(stepKB, 1, MaxLuaGCCount);
+            if (now - start + stepKB * gcPacerCostPerKB > budget && doneKB > 0.0)
+                break;
+
+            // GCdebt is negative while collector has credit, pay it first so step do real work
+            int credit = g->GCdebt < 0 ? (int)(-g->GCdebt / 1024) : 0;
+            int finished = lua_gc(L, LUA_GCSTEP, stepKB + credit);
+            gcPacerStats.steps++;
+            gcPacerStats.stepKB = stepKB;
 
-                auto luaStruct = deferGCStruct[0];
-                deferGCStruct.RemoveAtSwap(0);
-                delete luaStruct;
+            double current = FPlatformTime::Seconds();
+            double cost = current - now;
+            now = current;
+            doneKB += stepKB;
+            double costPerKB = cost / stepKB;
+            gcPacerCostPerKB = gcPacerCostPerKB > 0.0 ? gcPacerCostPerKB * 0.8 + costPerKB * 0.2 : costPerKB;
 
-                double currentSeconds = FPlatformTime::Seconds();
-                stepCost = currentSeconds - now;
-                now = currentSeconds;
+#if LUA_VERSION_NUM <= 503
+            if (cost * 10.0 > budget && g->gcfinnum > 4)
+            {
+                g->gcfinnum = 4;
             }
+#endif
+            if (finished) {
+                gcPacerStats.cycles++;
+                lastFullGCSeconds = current;
+#if !UE_BUILD_SHIPPING
+                PROFILER_WATCHER_X(fullGC, "FullGC");
+#endif
+                break;
+            }
+            if (now - start >= budget)
+                break;
         }
+
+        double frameCost = now - start;
+        gcPacerStats.lastCost = frameCost;
+        gcPacerStats.maxCost = FMath::Max(gcPacerStats.maxCost, frameCost);
+        gcPacerStats.avgCost = gcPacerStats.avgCost * 0.9 + frameCost * 0.1;
+        if (frameCost > budget)
+            gcPacerStats.overBudgetFrames++;
+        gcPacerStats.heapKB = lua_gc(L, LUA_GCCOUNT, 0);
     }
 
     void LuaState::tickLuaActors(float dtime) {
@@ -498,15 +921,35 @@ namespace NS_SLUA {
              LuaProfiler::clean(this);
 #endif
 #endif
+            // all objects will be freed, let allocator release pages at once
+            if (allocator)
+                allocator->beginBulkRelease();
+            // objects may be gone already, don't touch them on finalizing
+            LuaObject::setObjectCache(L, false);
+            // stop watchdog before lua_State gone
+            SafeDelete(deadLoopCheck);
             lua_close(L);
+            // lua_close push all remaining structs to defer list
+            for (auto luaStruct : deferGCStruct)
+                structPool->release(luaStruct);
+            deferGCStruct.Empty();
             GUObjectArray.RemoveUObjectCreateListener(this);
             GUObjectArray.RemoveUObjectDeleteListener(this);
             FCoreUObjectDelegates::GetPostGarbageCollect().Remove(pgcHandler);
             FWorldDelegates::OnWorldCleanup.Remove(wcHandler);
             stateMapFromIndex.Remove(si);
+            // results of unfinished prefetch are dropped
+            prefetchMap.Empty();
+            stateTemplate.Reset();
             L=nullptr;
+            innerAlloc = nullptr;
+            innerAllocUD = nullptr;
         }
+        SafeDelete(allocator);
+        SafeDelete(structPool);
+        SafeDelete(objCache);
         objRefs.Empty();
+        freeRefs.Empty();
         SafeDelete(deadLoopCheck);
 
         LuaMemoryProfile::stop();
@@ -514,6 +957,7 @@ namespace NS_SLUA {
         if (!mainState)
         {
             LuaFunctionAccelerator::clear();
+            LuaStaticBinding::clear();
         }
     }
 
@@ -539,24 +983,41 @@ namespace NS_SLUA {
         propLinks.Empty();
         classMap.clear();
         objRefs.Empty();
+        freeRefs.Empty();
 
 #if WITH_EDITOR
         // used for debug
         debugStringMap.Empty();
+#endif
 
-        if(!IsRunningCommandlet())
+#if !UE_BUILD_SHIPPING
+        if(ScriptWatchdog && !IsRunningCommandlet())
         {
             deadLoopCheck = new FDeadLoopCheck();
         }
 #endif
 
+        double initStart = FPlatformTime::Seconds();
+
+        if (SizeClassAlloc)
+            allocator = new LuaAllocator();
+        structPool = new LuaStructPool();
+        if (LuaObjectCache::isEnabled())
+            objCache = new LuaObjectCache();
+
         // use custom memory alloc func to profile memory footprint
 #if ENABLE_PROFILER && !UE_BUILD_SHIPPING
         L = lua_newstate(LuaMemoryProfile::alloc,this);
 #else
-        L = luaL_newstate();
+        if (allocator)
+            L = lua_newstate(LuaAllocator::alloc, allocator);
+        else
+            L = luaL_newstate();
 #endif
         
+        if (gcPacerBudget > 0.0)
+            setGCPacer(gcPacerBudget, gcPacerTargetKB, gcPacerFrameTime);
+
         lua_atpanic(L,_atPanic);
         // bind this to L
         *((void**)lua_getextraspace(L)) = this;
@@ -577,6 +1038,10 @@ namespace NS_SLUA {
         lua_newtable(L);
         cacheClassFuncRef = luaL_ref(L, LUA_REGISTRYINDEX);
 
+        // init accessor key anchor table
+        lua_newtable(L);
+        accessorKeyRef = luaL_ref(L, LUA_REGISTRYINDEX);
+
         ensure(lua_gettop(L)==0);
         
         luaL_openlibs(L);
@@ -613,6 +1078,9 @@ namespace NS_SLUA {
 
         InitExtLib(L);
 
+        LuaObject::setInlineCache(L, !!InlineCache);
+        LuaObject::setObjectCache(L, objCache != nullptr);
+
         LuaObject::init(L);
         LuaProtobuf::init(L);
         SluaUtil::openLib(L);
@@ -620,6 +1088,7 @@ namespace NS_SLUA {
         LuaArray::reg(L);
         LuaMap::reg(L);
         LuaSet::reg(L);
+        LuaArrayView::reg(L);
 #ifdef ENABLE_PROFILER
 #if !UE_BUILD_SHIPPING
         LuaProfiler::init(this);
@@ -628,6 +1097,10 @@ namespace NS_SLUA {
 
         lua_settop(L,0);
 
+        initStats.seconds = FPlatformTime::Seconds() - initStart;
+        initStats.heapKB = lua_gc(L, LUA_GCCOUNT, 0);
+        Log::Log("Lua state %s init cost %.3fms, heap %dkb", TCHAR_TO_UTF8(*stateName), initStats.seconds * 1000.0, initStats.heapKB);
+
         onInitEvent.Broadcast(L);
 
         return true;
@@ -647,6 +1120,10 @@ namespace NS_SLUA {
         loadFileDelegate = func;
     }
 
+    void LuaState::setLoadFileSpanDelegate(LoadFileSpanDelegate func) {
+        loadFileSpanDelegate = func;
+    }
+
     LuaState::ErrorDelegate* LuaState::getErrorDelegate()
     {
         return &errorDelegate;
@@ -749,13 +1226,22 @@ namespace NS_SLUA {
 
     LuaVar LuaState::doFile(const char* fn, LuaVar* pEnv) {
         FString filepath;
-        TArray<uint8> buf = loadFile(fn, filepath);
-        if (buf.Num() > 0) {
+        LuaFileSpan span;
+        if (loadFileSpan(loadFileSpanDelegate, loadFileDelegate, fn, filepath, span)) {
             char chunk[256];
             snprintf(chunk,256,"@%s",TCHAR_TO_UTF8(*filepath));
 
-            LuaVar r = doBuffer(buf.GetData(),buf.Num(),chunk,pEnv );
-            return r;
+            AutoStack g(L);
+            pushErrorHandler(L);
+            int ret = LuaBytecodeCache::loadBuffer(L, span.data, span.size, chunk);
+            span.reset();
+            if (ret) {
+                const char* err = lua_tostring(L,-1);
+                Log::Error("DoFile failed: %s",err);
+                return LuaVar();
+            }
+            LuaVar f(L, -1);
+            return f.call();
         }
         return LuaVar();
     }
@@ -787,10 +1273,20 @@ namespace NS_SLUA {
 
     void LuaState::NotifyUObjectDeleted(const UObjectBase * Object, int32 Index)
     {
-        classMap.cachePropMap.Remove((UStruct*)Object);
+#if defined(LUA_INLINE_CACHE)
+        if (classMap.remove((UStruct*)Object))
+            lua_resetinlinecache(L);
+#else
+        classMap.remove((UStruct*)Object);
+#endif
         LuaObject::removeCache(L, Object, cacheClassPropRef);
         LuaObject::removeCache(L, Object, cacheClassFuncRef);
         LuaFunctionAccelerator::remove((UFunction*)Object);
+        LuaStaticBinding::remove((UClass*)Object);
+        LuaObject::removeExtensionIndex((UClass*)Object);
+        // weak pushed object isn't in objRefs
+        if (objCache)
+            objCache->remove(Index);
 
         // indicate ud and all child had be free
         releaseLink((void*)Object);
@@ -845,7 +1341,10 @@ namespace NS_SLUA {
         ud->flag |= UD_HADFREE;
         // remove cache
         ensure(ud->ud == Object);
-        LuaObject::removeObjCache(L, (void*)Object);
+        if (objCache)
+            objCache->remove(GUObjectArray.ObjectToIndex(Object), ud);
+        else
+            LuaObject::removeObjCache(L, (void*)Object);
     }
 
     void LuaState::AddReferencedObjects(FReferenceCollector & Collector)
@@ -1140,6 +1639,24 @@ namespace NS_SLUA {
         fullGCInterval = interval;
     }
 
+    void LuaState::setGCPacer(double frameBudget, int targetHeapKB, double frameTime)
+    {
+        gcPacerBudget = frameBudget;
+        gcPacerTargetKB = targetHeapKB;
+        gcPacerFrameTime = frameTime;
+        gcPacerStats = GCPacerStats();
+        if (frameBudget > 0.0 && L && !innerAlloc) {
+            // count allocation to get allocation rate, still use origin allocator
+            innerAlloc = lua_getallocf(L, &innerAllocUD);
+            lua_setallocf(L, countAlloc, this);
+            lastAllocatedBytes = allocatedBytes;
+        }
+        else if (frameBudget <= 0.0 && L) {
+            lua_gc(L, LUA_GCSETPAUSE, DefaultGCPause);
+            lua_gc(L, LUA_GCSETSTEPMUL, DefaultGCStepMul);
+        }
+    }
+
     void LuaState::setTickFunction(LuaVar func)
     {
         stateTickFunc = func;
@@ -1163,10 +1680,13 @@ namespace NS_SLUA {
 
     int32 FDeadLoopCheck::NameCounter = 0;
     FDeadLoopCheck::FDeadLoopCheck()
-        : timeoutEvent(nullptr)
-        , timeoutCounter(0)
+        : seq(0)
+        , currentL(nullptr)
+        , enterCycles(0)
+        , sampledSeq(0)
+        , depth(0)
+        , currentSite(nullptr)
         , stopCounter(0)
-        , frameCounter(0)
     {
         thread = FRunnableThread::Create(this, *FString::Printf(TEXT("FLuaDeadLoopCheck_%d"), NameCounter++), 0, TPri_BelowNormal);
     }
@@ -1174,6 +1694,11 @@ namespace NS_SLUA {
     FDeadLoopCheck::~FDeadLoopCheck()
     {
         Stop();
+        {
+            // wait checker out of lua_State, it won't touch it again
+            FScopeLock lock(&hookLock);
+            currentL.store(nullptr);
+        }
         thread->WaitForCompletion();
         SafeDelete(thread);
     }
@@ -1181,11 +1706,30 @@ namespace NS_SLUA {
     uint32 FDeadLoopCheck::Run()
     {
         while (stopCounter.GetValue() == 0) {
-            FPlatformProcess::Sleep(1.0f);
-            if (frameCounter.GetValue() != 0) {
-                timeoutCounter.Increment();
-                if(timeoutCounter.GetValue() >= MaxLuaExecTime)
-                    onScriptTimeout();
+            FPlatformProcess::Sleep(FMath::Max(ScriptWatchdogIntervalMs, 1) / 1000.0f);
+
+            FScopeLock lock(&hookLock);
+            if (stopCounter.GetValue() != 0) break;
+
+            // read slot, retry next round if game thread is writing it
+            uint32 s = seq.load(std::memory_order_acquire);
+            if (s & 1) continue;
+            lua_State* L = currentL.load(std::memory_order_relaxed);
+            uint64 enter = enterCycles.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!L || seq.load(std::memory_order_relaxed) != s) continue;
+
+            // debugger hooked or our hook not fired yet
+            if (lua_gethook(L) != nullptr) continue;
+
+            double ms = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - enter) * 1000.0;
+            if (ms >= ScriptTimeoutSeconds * 1000.0) {
+                // lua_sethook is safe to call from other thread
+                lua_sethook(L, timeoutHook, LUA_MASKLINE, 0);
+            }
+            else if (ms >= ScriptWarnThresholdMs && sampledSeq.load(std::memory_order_relaxed) != s) {
+                sampledSeq.store(s, std::memory_order_relaxed);
+                lua_sethook(L, sampleHook, LUA_MASKCOUNT, 1);
             }
         }
         return 0;
@@ -1196,37 +1740,112 @@ namespace NS_SLUA {
         stopCounter.Increment();
     }
 
-    int FDeadLoopCheck::scriptEnter(ScriptTimeoutEvent* pEvent)
+    int FDeadLoopCheck::scriptEnter(lua_State* L, const void* site)
     {
-        int ret = frameCounter.Increment();
-        if ( ret == 1) {
-            timeoutCounter.Set(0);
-            timeoutEvent.store(pEvent);
-        }
-        return ret;
+        if (depth++ > 0) return depth;
+
+        currentSite = site;
+        uint32 s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        currentL.store(L, std::memory_order_relaxed);
+        enterCycles.store(FPlatformTime::Cycles64(), std::memory_order_relaxed);
+        seq.store(s + 2, std::memory_order_release);
+        return depth;
     }
 
     int FDeadLoopCheck::scriptLeave()
     {
-        return frameCounter.Decrement();
+        if (--depth > 0) return depth;
+
+        double ms = elapsedMs();
+        uint32 s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        currentL.store(nullptr, std::memory_order_relaxed);
+        seq.store(s + 2, std::memory_order_release);
+
+        if (ms >= ScriptWarnThresholdMs) {
+            auto& stats = callSites.FindOrAdd(callSiteName(currentSite));
+            int bucket = 0;
+            for (double limit = ScriptWarnThresholdMs * 2; bucket < ScriptCallSiteStats::NumBuckets - 1 && ms >= limit; limit *= 2)
+                bucket++;
+            stats.buckets[bucket]++;
+            stats.count++;
+            stats.totalMs += ms;
+            stats.maxMs = FMath::Max(stats.maxMs, ms);
+            if (!sampledLocation.IsEmpty())
+                stats.lastSample = sampledLocation;
+        }
+        sampledLocation.Empty();
+        currentSite = nullptr;
+        return 0;
+    }
+
+    double FDeadLoopCheck::elapsedMs() const
+    {
+        return FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - enterCycles.load(std::memory_order_relaxed)) * 1000.0;
+    }
+
+    void FDeadLoopCheck::sampleHook(lua_State *L, lua_Debug *ar)
+    {
+        lua_sethook(L, nullptr, 0, 0);
+        auto check = LuaState::get(L)->deadLoopCheck;
+        // hook set after that call returned, it's another call now
+        if (!check || check->depth == 0 || check->sampledSeq.load() != check->seq.load())
+            return;
+
+        lua_getinfo(L, "Sl", ar);
+        check->sampledLocation = FString::Printf(TEXT("%s:%d"), UTF8_TO_TCHAR(ar->short_src), ar->currentline);
+        UE_LOG(Slua, Warning, TEXT("Lua script %s running %.1fms, now at %s"),
+            *callSiteName(check->currentSite), check->elapsedMs(), *check->sampledLocation);
+    }
+
+    void FDeadLoopCheck::timeoutHook(lua_State *L, lua_Debug *ar)
+    {
+        lua_sethook(L, nullptr, 0, 0);
+        auto check = LuaState::get(L)->deadLoopCheck;
+        if (!check || check->depth == 0 || check->elapsedMs() < ScriptTimeoutSeconds * 1000.0)
+            return;
+        luaL_error(L, "script exec timeout");
     }
 
-    void FDeadLoopCheck::onScriptTimeout()
+    void FDeadLoopCheck::dumpCallSites() const
     {
-        auto pEvent = timeoutEvent.load();
-        if (pEvent) {
-            timeoutEvent.store(nullptr);
-            pEvent->onTimeout();
+        TArray<FString> names;
+        callSites.GetKeys(names);
+        names.Sort([this](const FString& a, const FString& b) {
+            return callSites[a].totalMs > callSites[b].totalMs;
+        });
+        UE_LOG(Slua, Log, TEXT("Lua calls over %.1fms, buckets by 1x 2x 4x 8x 16x of it"), ScriptWarnThresholdMs);
+        for (auto& name : names) {
+            auto& stats = callSites[name];
+            UE_LOG(Slua, Log, TEXT("%6u calls total %9.1fms max %8.1fms [%u %u %u %u %u] %s, sampled at %s"),
+                stats.count, stats.totalMs, stats.maxMs,
+                stats.buckets[0], stats.buckets[1], stats.buckets[2], stats.buckets[3], stats.buckets[4],
+                *name, stats.lastSample.IsEmpty() ? TEXT("-") : *stats.lastSample);
         }
     }
 
-    LuaScriptCallGuard::LuaScriptCallGuard(lua_State * L_)
+    void FDeadLoopCheck::clearCallSites()
+    {
+        callSites.Empty();
+    }
+
+    // only lua closures can be named, c functions and callable tables or userdata are not recorded
+    static const void* scriptSite(lua_State* L, int funcIdx) {
+        if (!funcIdx || lua_type(L, funcIdx) != LUA_TFUNCTION || lua_iscfunction(L, funcIdx))
+            return nullptr;
+        return lua_topointer(L, funcIdx);
+    }
+
+    LuaScriptCallGuard::LuaScriptCallGuard(lua_State * L_, int funcIdx)
         :L(L_)
     {
         auto ls = LuaState::get(L);
         if (ls->deadLoopCheck)
         {
-            ls->deadLoopCheck->scriptEnter(this);
+            ls->deadLoopCheck->scriptEnter(L, scriptSite(L, funcIdx));
         }
     }
 
@@ -1239,23 +1858,6 @@ namespace NS_SLUA {
         }
     }
 
-    void LuaScriptCallGuard::onTimeout()
-    {
-        auto hook = lua_gethook(L);
-        // if debugger isn't exists
-        if (hook == nullptr) {
-            // this function thread safe
-            lua_sethook(L, scriptTimeout, LUA_MASKLINE, 0);
-        }
-    }
-
-    void LuaScriptCallGuard::scriptTimeout(lua_State *L, lua_Debug *ar)
-    {
-        // only report once
-        lua_sethook(L, nullptr, 0, 0);
-        luaL_error(L, "script exec timeout");
-    }
-
     FProperty* LuaState::ClassCache::findProp(UStruct* ustruct, const char* pname)
     {
         auto item = cachePropMap.Find(ustruct);
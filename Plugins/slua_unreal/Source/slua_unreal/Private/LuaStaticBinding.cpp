@@ -0,0 +1,336 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "LuaStaticBinding.h"
+#include "LuaOverrider.h"
+#include "Log.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/IConsoleManager.h"
+
+namespace NS_SLUA {
+
+    static int32 StaticBinding = 1;
+    FAutoConsoleVariableRef CVarSluaStaticBinding(
+        TEXT("slua.StaticBinding"),
+        StaticBinding,
+        TEXT("Search generated static binding before reflection.\n"),
+        ECVF_Default);
+
+    namespace {
+        struct ClassEntries {
+            const LuaStaticBinding::Entry* entries;
+            int32 count;
+        };
+
+        // filled by static init of generated files
+        TMap<FString, ClassEntries>& registeredClasses() {
+            static TMap<FString, ClassEntries> classes;
+            return classes;
+        }
+
+        struct ResolvedEntry {
+            const LuaStaticBinding::Entry* entry;
+            // null for property
+            UFunction* func;
+        };
+
+        // entries of class and its super, sorted by name
+        TMap<UClass*, TArray<ResolvedEntry>> resolvedClasses;
+
+        TArray<ResolvedEntry>& resolve(UClass* cls) {
+            auto& resolved = resolvedClasses.Add(cls);
+            for (UClass* c = cls; c; c = c->GetSuperClass()) {
+                auto classEntries = registeredClasses().Find(c->GetName());
+                if (!classEntries)
+                    continue;
+                for (int32 i = 0; i < classEntries->count; i++) {
+                    auto entry = &classEntries->entries[i];
+                    // entry of subclass first
+                    if (resolved.ContainsByPredicate([entry](const ResolvedEntry& e) { return FCStringAnsi::Strcmp(e.entry->name, entry->name) == 0; }))
+                        continue;
+                    UFunction* func = nullptr;
+                    if (entry->func) {
+                        // overridden by blueprint, call it by reflection
+                        func = cls->FindFunctionByName(FName(UTF8_TO_TCHAR(entry->name)));
+                        if (!func || func->GetOuterUClass() != c)
+                            continue;
+                    }
+                    resolved.Add({ entry, func });
+                }
+            }
+            resolved.Sort([](const ResolvedEntry& a, const ResolvedEntry& b) {
+                return FCStringAnsi::Strcmp(a.entry->name, b.entry->name) < 0;
+            });
+            return resolved;
+        }
+    }
+
+    LuaStaticBinding::Registrar::Registrar(const TCHAR* className, const Entry* entries, int32 count)
+    {
+        registeredClasses().Add(className, { entries, count });
+    }
+
+    const LuaStaticBinding::Entry* LuaStaticBinding::find(UClass* cls, const char* name)
+    {
+        if (!StaticBinding || registeredClasses().Num() == 0)
+            return nullptr;
+
+        auto resolved = resolvedClasses.Find(cls);
+        auto& entries = resolved ? *resolved : resolve(cls);
+        int32 lo = 0, hi = entries.Num();
+        while (lo < hi) {
+            int32 mid = (lo + hi) / 2;
+            int c = FCStringAnsi::Strcmp(entries[mid].entry->name, name);
+            if (c == 0) {
+                // lua may hook the function after resolved, checked on every find
+                auto func = entries[mid].func;
+                return func && ULuaOverrider::isUFunctionHooked(func) ? nullptr : entries[mid].entry;
+            }
+            if (c < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        return nullptr;
+    }
+
+    bool LuaStaticBinding::isEnabled()
+    {
+        return StaticBinding != 0;
+    }
+
+    void LuaStaticBinding::remove(UClass* cls)
+    {
+        if (resolvedClasses.Num() > 0)
+            resolvedClasses.Remove(cls);
+    }
+
+    void LuaStaticBinding::clear()
+    {
+        resolvedClasses.Empty();
+    }
+
+#if WITH_EDITOR
+    namespace {
+        // c++ type LuaObject can check and push, empty if unsupported
+        FString bindingType(FProperty* prop) {
+            if (prop->IsA<FBoolProperty>())
+                return TEXT("bool");
+            if (auto p = CastField<FByteProperty>(prop))
+                return p->Enum ? FString() : TEXT("uint8");
+            if (prop->IsA<FNumericProperty>() || prop->IsA<FStrProperty>() || prop->IsA<FNameProperty>() || prop->IsA<FTextProperty>())
+                return prop->GetCPPType();
+            // soft and weak object property are different types
+            if (prop->GetClass() == FObjectProperty::StaticClass()) {
+                UClass* cls = CastField<FObjectProperty>(prop)->PropertyClass;
+                return FString::Printf(TEXT("%s%s*"), cls->GetPrefixCPP(), *cls->GetName());
+            }
+            return FString();
+        }
+
+        FString checkCode(FProperty* prop, const FString& type, const FString& idx) {
+            if (prop->IsA<FObjectProperty>())
+                return FString::Printf(TEXT("LuaStaticBinding::checkObject<%s>(L, %s)"), *type.LeftChop(1), *idx);
+            return FString::Printf(TEXT("LuaObject::checkValue<%s>(L, %s)"), *type, *idx);
+        }
+
+        FString pushCode(FProperty* prop, const FString& value) {
+            if (prop->IsA<FObjectProperty>())
+                return FString::Printf(TEXT("LuaObject::push(L, (UObject*)(%s))"), *value);
+            if (prop->IsA<FBoolProperty>())
+                return FString::Printf(TEXT("LuaObject::push(L, (bool)(%s))"), *value);
+            return FString::Printf(TEXT("LuaObject::push(L, %s)"), *value);
+        }
+
+        // returns false with reason if function can't be called directly
+        bool generateMethod(UClass* cls, UFunction* func, const FString& wrapper, FString& out, FString& reason) {
+            const EFunctionFlags unsupported = FUNC_Static | FUNC_Event | FUNC_Net | FUNC_EditorOnly | FUNC_Delegate;
+            if (!func->HasAnyFunctionFlags(FUNC_Native) || func->HasAnyFunctionFlags(unsupported)) {
+                reason = TEXT("not a plain native method");
+                return false;
+            }
+            if (!func->HasAnyFunctionFlags(FUNC_Public)) {
+                reason = TEXT("not public");
+                return false;
+            }
+            if (func->HasMetaData(TEXT("CustomThunk"))) {
+                reason = TEXT("custom thunk");
+                return false;
+            }
+
+            FString body;
+            FString args;
+            FProperty* returnProp = nullptr;
+            int32 idx = 2;
+            for (TFieldIterator<FProperty> it(func); it && (it->PropertyFlags & CPF_Parm); ++it) {
+                FProperty* prop = *it;
+                if (prop->HasAnyPropertyFlags(CPF_ReturnParm)) {
+                    returnProp = prop;
+                    continue;
+                }
+                // const reference accepts a value
+                if (prop->HasAnyPropertyFlags(CPF_OutParm) && !prop->HasAllPropertyFlags(CPF_ConstParm | CPF_ReferenceParm)) {
+                    reason = FString::Printf(TEXT("out param %s"), *prop->GetName());
+                    return false;
+                }
+                FString type = bindingType(prop);
+                if (type.IsEmpty()) {
+                    reason = FString::Printf(TEXT("unsupported param %s"), *prop->GetName());
+                    return false;
+                }
+                body += FString::Printf(TEXT("            auto a%d = %s;\n"), idx, *checkCode(prop, type, FString::FromInt(idx)));
+                args += FString::Printf(TEXT("%sa%d"), args.IsEmpty() ? TEXT("") : TEXT(", "), idx);
+                idx++;
+            }
+            if (returnProp && bindingType(returnProp).IsEmpty()) {
+                reason = TEXT("unsupported return value");
+                return false;
+            }
+
+            FString call = FString::Printf(TEXT("self->%s(%s)"), *func->GetName(), *args);
+            out += FString::Printf(TEXT("        int %s(lua_State* L) {\n"), *wrapper);
+            out += FString::Printf(TEXT("            auto self = LuaStaticBinding::checkSelf<%s%s>(L);\n"), cls->GetPrefixCPP(), *cls->GetName());
+            out += body;
+            if (returnProp)
+                out += FString::Printf(TEXT("            return %s;\n"), *pushCode(returnProp, call));
+            else
+                out += FString::Printf(TEXT("            %s;\n            return 0;\n"), *call);
+            out += TEXT("        }\n\n");
+            return true;
+        }
+
+        bool generateProperty(UClass* cls, FProperty* prop, const FString& wrapper, FString& out, bool& hasSetter, FString& reason) {
+            if (!prop->HasAnyPropertyFlags(CPF_NativeAccessSpecifierPublic) || prop->HasAnyPropertyFlags(CPF_EditorOnly)) {
+                reason = TEXT("not public");
+                return false;
+            }
+            FString type = bindingType(prop);
+            if (type.IsEmpty() || prop->ArrayDim != 1) {
+                reason = TEXT("unsupported type");
+                return false;
+            }
+            FString className = FString::Printf(TEXT("%s%s"), cls->GetPrefixCPP(), *cls->GetName());
+            FString member = FString::Printf(TEXT("static_cast<%s*>(obj)->%s"), *className, *prop->GetName());
+            out += FString::Printf(TEXT("        int %s_get(lua_State* L, UObject* obj) {\n"), *wrapper);
+            out += FString::Printf(TEXT("            return %s;\n        }\n\n"), *pushCode(prop, member));
+            // readonly property is reported by reflection
+            hasSetter = !prop->HasAnyPropertyFlags(CPF_BlueprintReadOnly | CPF_ConstParm);
+            if (hasSetter) {
+                out += FString::Printf(TEXT("        void %s_set(lua_State* L, UObject* obj, int valueIdx) {\n"), *wrapper);
+                out += FString::Printf(TEXT("            %s = %s;\n        }\n\n"), *member, *checkCode(prop, type, TEXT("valueIdx")));
+            }
+            return true;
+        }
+    }
+
+    bool LuaStaticBinding::generate(const TArray<FString>& classNames, const FString& outFile)
+    {
+        FString includes;
+        FString wrappers;
+        FString registrars;
+        for (auto& classSpec : classNames) {
+            // Class or Class:Member,Member
+            FString className = classSpec;
+            TArray<FString> memberNames;
+            FString members;
+            if (classSpec.Split(TEXT(":"), &className, &members))
+                members.ParseIntoArray(memberNames, TEXT(","));
+
+            UClass* cls = FindObject<UClass>(ANY_PACKAGE, *className);
+            if (!cls || !cls->HasAnyClassFlags(CLASS_Native)) {
+                Log::Error("Native class %s not found", TCHAR_TO_UTF8(*className));
+                return false;
+            }
+            FString includePath = cls->GetMetaData(TEXT("IncludePath"));
+            if (!includePath.IsEmpty())
+                includes += FString::Printf(TEXT("#include \"%s\"\n"), *includePath);
+
+            FString cppName = FString::Printf(TEXT("%s%s"), cls->GetPrefixCPP(), *cls->GetName());
+            TArray<UFunction*> funcs;
+            TArray<FProperty*> props;
+            if (memberNames.Num() == 0) {
+                for (TFieldIterator<UFunction> it(cls, EFieldIteratorFlags::ExcludeSuper); it; ++it)
+                    funcs.Add(*it);
+                for (TFieldIterator<FProperty> it(cls, EFieldIteratorFlags::ExcludeSuper); it; ++it)
+                    props.Add(*it);
+            }
+            for (auto& memberName : memberNames) {
+                if (UFunction* func = cls->FindFunctionByName(*memberName, EIncludeSuperFlag::ExcludeSuper))
+                    funcs.Add(func);
+                else if (FProperty* prop = FindFProperty<FProperty>(cls, *memberName))
+                    props.Add(prop);
+                else
+                    Log::Error("Member %s of %s not found", TCHAR_TO_UTF8(*memberName), TCHAR_TO_UTF8(*className));
+            }
+
+            FString entries;
+            for (auto func : funcs) {
+                FString wrapper = cppName + TEXT("_") + func->GetName();
+                FString reason;
+                if (generateMethod(cls, func, wrapper, wrappers, reason))
+                    entries += FString::Printf(TEXT("            { \"%s\", %s, nullptr, nullptr },\n"), *func->GetName(), *wrapper);
+                else
+                    wrappers += FString::Printf(TEXT("        // skip %s::%s, %s\n\n"), *cppName, *func->GetName(), *reason);
+            }
+            for (auto prop : props) {
+                FString wrapper = cppName + TEXT("_") + prop->GetName();
+                FString reason;
+                bool hasSetter = false;
+                if (generateProperty(cls, prop, wrapper, wrappers, hasSetter, reason))
+                    entries += FString::Printf(TEXT("            { \"%s\", nullptr, %s_get, %s },\n"), *prop->GetName(), *wrapper,
+                        hasSetter ? *(wrapper + TEXT("_set")) : TEXT("nullptr"));
+                else
+                    wrappers += FString::Printf(TEXT("        // skip %s::%s, %s\n\n"), *cppName, *prop->GetName(), *reason);
+            }
+            if (entries.IsEmpty())
+                continue;
+            registrars += FString::Printf(TEXT("        const LuaStaticBinding::Entry %sEntries[] = {\n%s        };\n"), *cppName, *entries);
+            registrars += FString::Printf(TEXT("        LuaStaticBinding::Registrar %sRegistrar(TEXT(\"%s\"), %sEntries, (int32)(sizeof(%sEntries) / sizeof(%sEntries[0])));\n\n"),
+                *cppName, *cls->GetName(), *cppName, *cppName, *cppName);
+        }
+
+        FString content = TEXT("// generated by slua.GenStaticBinding, don't edit\n\n");
+        content += TEXT("#include \"LuaStaticBinding.h\"\n") + includes;
+        content += TEXT("\nnamespace NS_SLUA {\n\n    namespace {\n");
+        content += wrappers + registrars;
+        content += TEXT("    }\n}\n");
+        if (!FFileHelper::SaveStringToFile(content, *outFile)) {
+            Log::Error("Can't write static binding %s", TCHAR_TO_UTF8(*outFile));
+            return false;
+        }
+        Log::Log("Generate static binding %s, %d classes", TCHAR_TO_UTF8(*outFile), classNames.Num());
+        return true;
+    }
+
+    static void genStaticBinding(const TArray<FString>& args) {
+        if (args.Num() < 2) {
+            Log::Log("Usage: slua.GenStaticBinding <output file> <class>[:member,member...] [class...]");
+            return;
+        }
+        FString out = FPaths::IsRelative(args[0]) ? FPaths::GameSourceDir() / args[0] : args[0];
+        TArray<FString> classNames(args.GetData() + 1, args.Num() - 1);
+        LuaStaticBinding::generate(classNames, out);
+    }
+
+    static FAutoConsoleCommand CVarGenStaticBinding(
+        TEXT("slua.GenStaticBinding"),
+        TEXT("Generate static lua binding of native classes, output file relative to Source"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(genStaticBinding),
+        ECVF_Cheat);
+#else
+    bool LuaStaticBinding::generate(const TArray<FString>& classNames, const FString& outFile)
+    {
+        Log::Error("Static binding can only be generated in editor");
+        return false;
+    }
+#endif
+}
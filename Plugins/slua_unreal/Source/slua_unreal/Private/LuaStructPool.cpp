@@ -0,0 +1,129 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "LuaStructPool.h"
+#include "LuaObject.h"
+#include "Log.h"
+#include "HAL/IConsoleManager.h"
+
+namespace NS_SLUA {
+
+    static int32 StructPool = 1;
+    FAutoConsoleVariableRef CVarSluaStructPool(
+        TEXT("slua.StructPool"),
+        StructPool,
+        TEXT("Recycle LuaStruct and its buffer by size class of struct.\n"),
+        ECVF_Default);
+
+    namespace {
+        const uint32 ClassSizes[LuaStructPool::NumSizeClasses] = {
+            16, 32, 48, 64, 96, 128, 192, 256, 384, 512
+        };
+        const uint32 HeaderSize = Align((uint32)sizeof(LuaStruct), LuaStructPool::BufferAlignment);
+
+        int sizeClassOf(uint32 size) {
+            for (int i = 0; i < LuaStructPool::NumSizeClasses; i++)
+                if (size <= ClassSizes[i]) return i;
+            return -1;
+        }
+    }
+
+    LuaStructPool::LuaStructPool()
+    {
+        FMemory::Memzero(stats);
+    }
+
+    LuaStructPool::~LuaStructPool()
+    {
+        for (auto& freeList : freeLists) {
+            for (auto ls : freeList)
+                destroy(ls);
+            freeList.Empty();
+        }
+    }
+
+    uint32 LuaStructPool::sizeOfClass(int index)
+    {
+        return index < NumSizeClasses ? ClassSizes[index] : 0;
+    }
+
+    LuaStruct* LuaStructPool::acquire(UScriptStruct* uss)
+    {
+        uint32 size = uss->GetStructureSize() ? uss->GetStructureSize() : 1;
+        int sc = StructPool && (uint32)uss->GetMinAlignment() <= BufferAlignment ? sizeClassOf(size) : -1;
+        if (sc < 0) {
+            stats.bypass++;
+            return nullptr;
+        }
+
+        LuaStruct* ls;
+        auto& freeList = freeLists[sc];
+        if (freeList.Num() > 0) {
+            ls = freeList.Pop(false);
+            stats.hits++;
+            stats.idle--;
+        }
+        else {
+            void* block = FMemory::Malloc(HeaderSize + ClassSizes[sc], BufferAlignment);
+            ls = new (block) LuaStruct();
+            ls->poolClass = sc;
+            stats.misses++;
+        }
+        stats.live++;
+        stats.maxLive = FMath::Max(stats.maxLive, stats.live);
+
+        uint8* buf = (uint8*)ls + HeaderSize;
+        uss->InitializeStruct(buf);
+        ls->Init(buf, size, uss, false);
+        return ls;
+    }
+
+    void LuaStructPool::release(LuaStruct* ls)
+    {
+        if (ls->poolClass < 0) {
+            delete ls;
+            return;
+        }
+
+        ls->uss->DestroyStruct(ls->buf);
+        ls->uss = nullptr;
+        stats.live--;
+
+        auto& freeList = freeLists[ls->poolClass];
+        if (freeList.Num() >= MaxFreePerClass) {
+            stats.trimmed++;
+            destroy(ls);
+            return;
+        }
+        freeList.Add(ls);
+        stats.idle++;
+        stats.maxIdle = FMath::Max(stats.maxIdle, stats.idle);
+    }
+
+    void LuaStructPool::destroy(LuaStruct* ls)
+    {
+        // buffer is part of the block, struct in it has been destroyed
+        ls->~LuaStruct();
+        FMemory::Free(ls);
+    }
+
+    void LuaStructPool::dumpStats() const
+    {
+        uint64 total = stats.hits + stats.misses;
+        Log::Log("Lua struct pool hits %llu, misses %llu (%.1f%% hit), bypass %llu, trimmed %llu",
+            stats.hits, stats.misses, total ? stats.hits * 100.0 / total : 0.0, stats.bypass, stats.trimmed);
+        Log::Log("Lua struct pool live %d (max %d), idle %d (max %d)", stats.live, stats.maxLive, stats.idle, stats.maxIdle);
+        for (int i = 0; i < NumSizeClasses; i++)
+            Log::Log("size %4u: idle %d", ClassSizes[i], freeLists[i].Num());
+    }
+}
@@ -22,12 +22,13 @@
 #include "UObject/Stack.h"
 #include "Blueprint/WidgetTree.h"
 #include "LuaState.h"
+#include "LuaFunctionAccelerator.h"
 #include "lstate.h"
 // #include "CrashContextCollector.h" // For PUBG Mobile
 
 namespace NS_SLUA {
 
-    FSafeOutputDelegate LuaVar::safeOutputLambda;
+    TFunctionRef<void()>* LuaVar::safeOutputFunc = nullptr;
 
     const int INVALID_INDEX = -1;
     LuaVar::LuaVar()
@@ -162,16 +163,14 @@ namespace NS_SLUA {
             break;
         case LV_LIGHTUD:
             alloc(1);
-            vars[0].ptr = lua_touserdata(l,p);
-            vars[0].luatype = type;
+            getVars()[0].ptr = lua_touserdata(l,p);
+            getVars()[0].luatype = type;
             break;
         case LV_FUNCTION: 
         case LV_TABLE:
         case LV_USERDATA:
             alloc(1);
-            lua_pushvalue(l,p);
-            vars[0].ref = new RefRef(l);
-            vars[0].luatype=type;
+            setRef(getVars()[0],l,p,type);
             break;
         case LV_TUPLE:
             ensure(p>0 && lua_gettop(l)>=p);
@@ -188,15 +187,14 @@ namespace NS_SLUA {
         if (!L || L != other.getState()) { return false; }
 
         if (numOfVar != other.numOfVar) { return false; }
-        if (numOfVar == 0 && vars == nullptr && other.vars == nullptr)
+        if (numOfVar == 0)
         {
             return true;
         }
-        if (vars == nullptr || other.vars == nullptr) { return false; }
 
         for (size_t i = 0; i < numOfVar; i++) {
-            Type luatype = vars[i].luatype;
-            if (luatype != other.vars[i].luatype)
+            Type luatype = getVars()[i].luatype;
+            if (luatype != other.getVars()[i].luatype)
             {
                 return false;
             }
@@ -204,28 +202,28 @@ namespace NS_SLUA {
             switch (luatype) {
                 case LV_BOOL:
                 {
-                    if (vars[i].b != other.vars[i].b) {
+                    if (getVars()[i].b != other.getVars()[i].b) {
                         return false;
                     }
                     break;
                 }
                 case LV_INT:
                 {
-                    if (vars[i].i != other.vars[i].i) {
+                    if (getVars()[i].i != other.getVars()[i].i) {
                         return false;
                     }
                     break;
                 }
                 case LV_NUMBER:
                 {
-                    if (vars[i].d != other.vars[i].d) {
+                    if (getVars()[i].d != other.getVars()[i].d) {
                         return false;
                     }
                     break;
                 }
                 case LV_STRING: 
                 {
-                    if (strcmp(vars[i].s->buf, other.vars[i].s->buf) != 0) {
+                    if (strcmp(stringBuf(getVars()[i]), stringBuf(other.getVars()[i])) != 0) {
                         return false;
                     }
                     break;
@@ -234,10 +232,10 @@ namespace NS_SLUA {
                 case LV_TABLE:
                 case LV_USERDATA:
                 {
-                    if (!vars[i].ref || !other.vars[i].ref) { return false; }
+                    if (getVars()[i].ref == LUA_NOREF || other.getVars()[i].ref == LUA_NOREF) { return false; }
 
-                    lua_rawgeti(L, LUA_REGISTRYINDEX, vars[i].ref->ref);
-                    lua_rawgeti(L, LUA_REGISTRYINDEX, other.vars[i].ref->ref);
+                    lua_rawgeti(L, LUA_REGISTRYINDEX, getVars()[i].ref);
+                    lua_rawgeti(L, LUA_REGISTRYINDEX, other.getVars()[i].ref);
                     bool bEqual = lua_compare(L, -1, -2, LUA_OPEQ) == 1;
                     lua_pop(L, 2);
                     if (!bEqual)
@@ -248,7 +246,7 @@ namespace NS_SLUA {
                 }
                 case LV_LIGHTUD:
                 {
-                    if (vars[i].ptr != other.vars[i].ptr) {
+                    if (getVars()[i].ptr != other.getVars()[i].ptr) {
                         return false;
                     }
                     break;
@@ -272,50 +270,43 @@ namespace NS_SLUA {
 
             switch(t) {
             case LUA_TBOOLEAN:
-                vars[i].luatype = LV_BOOL;
-                vars[i].b = !!lua_toboolean(l, p);
+                getVars()[i].luatype = LV_BOOL;
+                getVars()[i].b = !!lua_toboolean(l, p);
                 break;
             case LUA_TNUMBER:
                 {
                     if(lua_isinteger(l,p)) {
-                        vars[i].luatype = LV_INT;
-                        vars[i].i = lua_tointeger(l,p);
+                        getVars()[i].luatype = LV_INT;
+                        getVars()[i].i = lua_tointeger(l,p);
                     }
                     else {
-                        vars[i].luatype = LV_NUMBER;
-                        vars[i].d = lua_tonumber(l,p);
+                        getVars()[i].luatype = LV_NUMBER;
+                        getVars()[i].d = lua_tonumber(l,p);
                     }
                 }
                 break;
             case LUA_TSTRING: {
-                vars[i].luatype = LV_STRING;
                 size_t len;
                 const char* buf = lua_tolstring(l, p, &len);
-                vars[i].s = new RefStr(buf,len);
+                setString(getVars()[i],buf,len);
                 break;
             }
             case LUA_TFUNCTION:
-                vars[i].luatype = LV_FUNCTION;
-                lua_pushvalue(l,p);
-                vars[i].ref = new RefRef(l);
+                setRef(getVars()[i],l,p,LV_FUNCTION);
                 break;
             case LUA_TTABLE:
-                vars[i].luatype = LV_TABLE;
-                lua_pushvalue(l,p);
-                vars[i].ref = new RefRef(l);
+                setRef(getVars()[i],l,p,LV_TABLE);
                 break;
             case LUA_TUSERDATA:
-                vars[i].luatype = LV_USERDATA;
-                lua_pushvalue(l, p);
-                vars[i].ref = new RefRef(l);
+                setRef(getVars()[i],l,p,LV_USERDATA);
                 break;
             case LUA_TLIGHTUSERDATA:
-                vars[i].luatype = LV_LIGHTUD;
-                vars[i].ptr = lua_touserdata(l, p);
+                getVars()[i].luatype = LV_LIGHTUD;
+                getVars()[i].ptr = lua_touserdata(l, p);
                 break;
             case LUA_TNIL:
             default:
-                vars[i].luatype = LV_NIL;
+                getVars()[i].luatype = LV_NIL;
                 break;
             }
         }
@@ -325,43 +316,61 @@ namespace NS_SLUA {
         free();
     }
 
-    LuaVar::RefRef::RefRef(lua_State* l) 
-        :LuaVar::Ref() 
-    {
-        ref=luaL_ref(l,LUA_REGISTRYINDEX);
-        stateIndex = LuaState::get(l)->stateIndex();
-#if UE_BUILD_DEVELOPMENT
-        LuaState::get(l)->addRefTraceback(ref);
-#endif
+    void LuaVar::setString(lua_var& v,const char* buf,size_t len) {
+        if(len<InlineStrSize) {
+            FMemory::Memcpy(v.str,buf,len);
+            v.str[len] = 0;
+            v.inlineLen = len+1;
+        }
+        else {
+            v.s = new RefStr(buf,len);
+            v.inlineLen = 0;
+        }
+        v.luatype = LV_STRING;
     }
 
-    LuaVar::RefRef::~RefRef() {
-        if(LuaState::isValid(stateIndex)) {
-            auto state = LuaState::get(stateIndex);
-            if (state) {
-                luaL_unref(state->getLuaState(),LUA_REGISTRYINDEX,ref);
-#if UE_BUILD_DEVELOPMENT
-                state->removeRefTraceback(ref);
-#endif
+    void LuaVar::setRef(lua_var& v,lua_State* l,int p,Type t) {
+        lua_pushvalue(l,p);
+        v.ref = LuaState::get(l)->refValue(l);
+        v.luatype = t;
+    }
+
+    void LuaVar::varFree(lua_var& v) {
+        switch(v.luatype) {
+        case LV_FUNCTION:
+        case LV_TABLE:
+        case LV_USERDATA:
+            if(v.ref!=LUA_NOREF && LuaState::isValid(stateIndex)) {
+                if(auto state = LuaState::get(stateIndex))
+                    state->unrefValue(v.ref);
             }
+            break;
+        case LV_STRING:
+            if(!v.inlineLen)
+                v.s->release();
+            break;
+        default:
+            break;
         }
     }
 
     void LuaVar::free() {
-        for(size_t n=0;n<numOfVar;n++) {
-            if( (vars[n].luatype==LV_FUNCTION || vars[n].luatype==LV_TABLE || vars[n].luatype == LV_USERDATA)
-                && vars[n].ref->isValid() )
-                vars[n].ref->release();
-            else if(vars[n].luatype==LV_STRING)
-                vars[n].s->release();
-        }
+        lua_var* v = getVars();
+        for(size_t n=0;n<numOfVar;n++)
+            varFree(v[n]);
+        if(numOfVar>1)
+            delete[] vars;
         numOfVar = 0;
-        delete[] vars;
         vars = nullptr;
     }
 
     void LuaVar::alloc(int n) {
-        if(n>0) {
+        if(n==1) {
+            // don't point vars to inlineVar, LuaVar may be moved by memmove in UE containers
+            vars = nullptr;
+            numOfVar = 1;
+        }
+        else if(n>1) {
             vars = new lua_var[n];
             numOfVar = n;
         }
@@ -410,11 +419,11 @@ namespace NS_SLUA {
 
     int LuaVar::asInt() const {
         ensure(numOfVar==1);
-        switch(vars[0].luatype) {
+        switch(getVars()[0].luatype) {
         case LV_INT:
-            return vars[0].i;
+            return getVars()[0].i;
         case LV_NUMBER:
-            return vars[0].d;
+            return getVars()[0].d;
         default:
             return -1;
         }
@@ -422,11 +431,11 @@ namespace NS_SLUA {
 
     int64 LuaVar::asInt64() const {
         ensure(numOfVar==1);
-        switch(vars[0].luatype) {
+        switch(getVars()[0].luatype) {
         case LV_INT:
-            return vars[0].i;
+            return getVars()[0].i;
         case LV_NUMBER:
-            return vars[0].d;
+            return getVars()[0].d;
         default:
             return -1;
         }
@@ -434,11 +443,11 @@ namespace NS_SLUA {
 
     float LuaVar::asFloat() const {
         ensure(numOfVar==1);
-        switch(vars[0].luatype) {
+        switch(getVars()[0].luatype) {
         case LV_INT:
-            return vars[0].i;
+            return getVars()[0].i;
         case LV_NUMBER:
-            return vars[0].d;
+            return getVars()[0].d;
         default:
             return NAN;
         }
@@ -446,36 +455,36 @@ namespace NS_SLUA {
 
     double LuaVar::asDouble() const {
         ensure(numOfVar==1);
-        switch(vars[0].luatype) {
+        switch(getVars()[0].luatype) {
         case LV_INT:
-            return vars[0].i;
+            return getVars()[0].i;
         case LV_NUMBER:
-            return vars[0].d;
+            return getVars()[0].d;
         default:
             return NAN;
         }
     }
 
     const char* LuaVar::asString(size_t* outlen) const {
-        ensure(numOfVar==1 && vars[0].luatype==LV_STRING);
-        if(outlen) *outlen = vars[0].s->length;
-        return vars[0].s->buf;
+        ensure(numOfVar==1 && getVars()[0].luatype==LV_STRING);
+        if(outlen) *outlen = stringLen(getVars()[0]);
+        return stringBuf(getVars()[0]);
     }
 
     LuaLString LuaVar::asLString() const
     {
-        ensure(numOfVar == 1 && vars[0].luatype == LV_STRING);
-        return { vars[0].s->buf,vars[0].s->length };
+        ensure(numOfVar == 1 && getVars()[0].luatype == LV_STRING);
+        return { stringBuf(getVars()[0]),stringLen(getVars()[0]) };
     }
 
     bool LuaVar::asBool() const {
-        ensure(numOfVar==1 && vars[0].luatype==LV_BOOL);
-        return vars[0].b;
+        ensure(numOfVar==1 && getVars()[0].luatype==LV_BOOL);
+        return getVars()[0].b;
     }
 
     void* LuaVar::asLightUD() const {
-        ensure(numOfVar==1 && vars[0].luatype==LV_LIGHTUD);
-        return vars[0].ptr;
+        ensure(numOfVar==1 && getVars()[0].luatype==LV_LIGHTUD);
+        return getVars()[0].ptr;
     }
 
     LuaVar LuaVar::getAt(size_t index) const {
@@ -493,7 +502,7 @@ namespace NS_SLUA {
             LuaVar r;
             r.alloc(1);
             r.stateIndex = this->stateIndex;
-            varClone(r.vars[0],vars[index-1]);
+            varClone(r.getVars()[0],getVars()[index-1]);
             return r;
         }
     }
@@ -501,29 +510,28 @@ namespace NS_SLUA {
     void LuaVar::set(lua_Integer v) {
         free();
         alloc(1);
-        vars[0].i = v;
-        vars[0].luatype = LV_INT;
+        getVars()[0].i = v;
+        getVars()[0].luatype = LV_INT;
     }
 
     void LuaVar::set(int v) {
         free();
         alloc(1);
-        vars[0].i = v;
-        vars[0].luatype = LV_INT;
+        getVars()[0].i = v;
+        getVars()[0].luatype = LV_INT;
     }
 
     void LuaVar::set(lua_Number v) {
         free();
         alloc(1);
-        vars[0].d = v;
-        vars[0].luatype = LV_NUMBER;
+        getVars()[0].d = v;
+        getVars()[0].luatype = LV_NUMBER;
     }
 
     void LuaVar::set(const char* v,size_t len) {
         free();
         alloc(1);
-        vars[0].s = new RefStr(v,len);
-        vars[0].luatype = LV_STRING;
+        setString(getVars()[0],v,len);
     }
 
     void LuaVar::set(const LuaLString & lstr)
@@ -534,8 +542,8 @@ namespace NS_SLUA {
     void LuaVar::set(bool b) {
         free();
         alloc(1);
-        vars[0].b = b;
-        vars[0].luatype = LV_BOOL;
+        getVars()[0].b = b;
+        getVars()[0].luatype = LV_BOOL;
     }
 
     void LuaVar::pushVar(lua_State* l,const lua_var& ov) const {
@@ -550,12 +558,12 @@ namespace NS_SLUA {
             lua_pushboolean(l,ov.b);
             break;
         case LV_STRING:
-            lua_pushlstring(l,ov.s->buf,ov.s->length);
+            lua_pushlstring(l,stringBuf(ov),stringLen(ov));
             break;
         case LV_FUNCTION:
         case LV_TABLE:
         case LV_USERDATA:
-            ov.ref->push(l);
+            lua_rawgeti(l,LUA_REGISTRYINDEX,ov.ref);
             break;
         case LV_LIGHTUD:
             lua_pushlightuserdata(l,ov.ptr);
@@ -570,18 +578,18 @@ namespace NS_SLUA {
         if(l==nullptr) l=getState();
         if(l==nullptr) return 0;
 
-        if(vars==nullptr || numOfVar==0) {
+        if(numOfVar==0) {
             lua_pushnil(l);
             return 1;
         }
         
         if(numOfVar==1) {
-            const lua_var& ov = vars[0];
+            const lua_var& ov = getVars()[0];
             pushVar(l,ov);
             return 1;
         }
         for(size_t n=0;n<numOfVar;n++) {
-            const lua_var& ov = vars[n];
+            const lua_var& ov = getVars()[n];
             pushVar(l,ov);
         }
         return numOfVar;
@@ -592,11 +600,11 @@ namespace NS_SLUA {
     }
 
     bool LuaVar::isNil() const {
-        return vars==nullptr || numOfVar==0;
+        return numOfVar==0;
     }
 
     bool LuaVar::isFunction() const {
-        return numOfVar==1 && vars[0].luatype==LV_FUNCTION;
+        return numOfVar==1 && getVars()[0].luatype==LV_FUNCTION;
     }
 
     bool LuaVar::isTuple() const {
@@ -604,23 +612,23 @@ namespace NS_SLUA {
     }
 
     bool LuaVar::isTable() const {
-        return numOfVar==1 && vars[0].luatype==LV_TABLE;
+        return numOfVar==1 && getVars()[0].luatype==LV_TABLE;
     }
 
     bool LuaVar::isInt() const {
-        return numOfVar==1 && vars[0].luatype==LV_INT;
+        return numOfVar==1 && getVars()[0].luatype==LV_INT;
     }
 
     bool LuaVar::isNumber() const {
-        return numOfVar==1 && vars[0].luatype==LV_NUMBER;
+        return numOfVar==1 && getVars()[0].luatype==LV_NUMBER;
     }
 
     bool LuaVar::isBool() const {
-        return numOfVar==1 && vars[0].luatype==LV_BOOL;
+        return numOfVar==1 && getVars()[0].luatype==LV_BOOL;
     }
 
     bool LuaVar::isUserdata(const char* t) const {
-        if(numOfVar==1 && vars[0].luatype==LV_USERDATA) {
+        if(numOfVar==1 && getVars()[0].luatype==LV_USERDATA) {
             auto L = getState();
             push(L);
             void* p = luaL_testudata(L, -1, t);
@@ -631,18 +639,18 @@ namespace NS_SLUA {
     }
 
     bool LuaVar::isLightUserdata() const {
-        return numOfVar==1 && vars[0].luatype==LV_LIGHTUD;
+        return numOfVar==1 && getVars()[0].luatype==LV_LIGHTUD;
     }
 
     bool LuaVar::isString() const {
-        return numOfVar==1 && vars[0].luatype==LV_STRING;
+        return numOfVar==1 && getVars()[0].luatype==LV_STRING;
     }
 
     LuaVar::Type LuaVar::type() const {
         if(numOfVar==0)
             return LV_NIL;
         else if(numOfVar==1)
-            return vars[0].luatype;
+            return getVars()[0].luatype;
         else
             return LV_TUPLE;
     }
@@ -654,15 +662,26 @@ namespace NS_SLUA {
             return 0;
         }
         auto L = getState();
-        int errhandle = LuaState::pushErrorHandler(L);
-        vars[0].ref->push(L);
+        int errhandle = beginCall(L);
         int argn = 0;
         if (fillParam) {
             argn = fillParam();
         }
+        return endCall(L, errhandle, argn);
+    }
+
+    int LuaVar::beginCall(lua_State* L) const
+    {
+        int errhandle = LuaState::pushErrorHandler(L);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, getVars()[0].ref);
+        return errhandle;
+    }
+
+    int LuaVar::endCall(lua_State* L, int errhandle, int argn) const
+    {
         {
-#if WITH_EDITOR
-            LuaScriptCallGuard g(L);
+#if !UE_BUILD_SHIPPING
+            LuaScriptCallGuard g(L, errhandle + 1);
 #endif
             if (lua_pcallk(L, argn, LUA_MULTRET, errhandle, NULL, NULL))
                 lua_pop(L, 1);
@@ -671,13 +690,6 @@ namespace NS_SLUA {
         return lua_gettop(L) - errhandle + 1;
     }
 
-    int LuaVar::pushArgByParms(FProperty* prop,uint8* parms) {
-        auto L = getState();
-        if (LuaObject::push(L,prop,parms,nullptr))
-            return prop->ElementSize;
-        return 0;
-    }
-
     bool LuaVar::callByUFunction(UFunction* func,uint8* parms,FOutParmRec *outParams,LuaVar* pSelf) {
         
         if(!func) return false;
@@ -704,83 +716,69 @@ namespace NS_SLUA {
                 return nArg;
             };
 
-            int n = docall(fillParam);
+            int n = docall(L, fillParam);
             lua_pop(L, n);
             return true;
         }
 
+        // params resolved once per function, shared with calls from lua
+        auto acc = LuaFunctionAccelerator::findOrAdd(func);
+        if (!acc->bLuaCallInit)
+            acc->initLuaCall();
+
         auto fillParam = [&]
         {
             // push self if valid
             int nArg = 0;
             if (pSelf) {
-                pSelf->push();
+                pSelf->push(L);
                 nArg++;
             }
             // push arguments to lua state
-            for (TFieldIterator<FProperty> it(func); it && (it->PropertyFlags & CPF_Parm); ++it) {
-                FProperty* prop = *it;
-                uint64 propflag = prop->GetPropertyFlags();
-                if (func->HasAnyFunctionFlags(FUNC_Native)) {
-                    if (propflag & CPF_ReturnParm)
-                        continue;
-                }
-                else if (IsRealOutParam(propflag))
-                    continue;
-                if (outParams && (propflag & CPF_OutParm) && (propflag & CPF_BlueprintReadOnly)) {
+            for (auto& arg : acc->luaCallArgs) {
+                uint8* addr = parms + arg.offset;
+                if (outParams && arg.bOutParm) {
                     FOutParmRec* out = outParams;
-                    while (out->Property != prop) {
+                    while (out->Property != arg.prop) {
                         out = out->NextOutParm;
-                        checkSlow(Out);
+                        checkSlow(out);
                     }
-                    pushArgByParms(prop, out->PropAddr);
-                    nArg++;
-                }
-                else {
-                    pushArgByParms(prop, parms + prop->GetOffset_ForInternal());
-                    nArg++;
+                    addr = out->PropAddr;
                 }
-                
+                if (arg.pusher)
+                    arg.pusher(L, arg.prop, addr, nullptr);
+                else
+                    LuaObject::push(L, arg.prop, addr);
+                nArg++;
             }
             return nArg;
         };
         
-        int retCount = docall(fillParam);
+        int retCount = docall(L, fillParam);
         int remain = retCount;
 
-        auto checkOutputValue = [&](FProperty *prop) {
-            auto checker = LuaObject::getChecker(prop);
-            FOutParmRec* out = outParams;
-            while (out && out->Property != prop) {
-                out = out->NextOutParm;
-            }
-            uint8* outParam = out ? out->PropAddr : parms + prop->GetOffset_ForInternal();
-            if (checker) {
-                (*checker)(L, prop, outParam, lua_absindex(L, -remain), true);
-            }
-            remain--;
-        };
-
         if (remain > 0)
         {
-            safeOutputLambda = FSafeOutputDelegate::CreateLambda([&]()
+            auto output = [&]()
             {
-                // if lua return value
-                // we only handle first lua return value
-                if (bHasReturnParam) {
-                    auto prop = func->GetReturnProperty();
-                    checkOutputValue(prop);
-                }
-
-                // fill lua return value to blueprint stack if argument is out param
-                for (TFieldIterator<FProperty> it(func); remain > 0 && it && (it->PropertyFlags & CPF_Parm); ++it) {
-                    FProperty* prop = *it;
-                    uint64 propflag = prop->GetPropertyFlags();
-                    if (IsRealOutParam(propflag)) {
-                        checkOutputValue(prop);
+                // first lua return value to return value, then to blueprint stack if argument is out param
+                for (int i = 0; remain > 0 && i < acc->luaCallResults.Num(); i++) {
+                    auto& result = acc->luaCallResults[i];
+                    FOutParmRec* out = outParams;
+                    while (out && out->Property != result.prop) {
+                        out = out->NextOutParm;
                     }
+                    uint8* outParam = out ? out->PropAddr : parms + result.offset;
+                    if (result.checker) {
+                        result.checker(L, result.prop, outParam, lua_absindex(L, -remain), true);
+                    }
+                    remain--;
                 }
-            });
+            };
+            // lambda lives on stack, safeOutput reaches it by pointer
+            TFunctionRef<void()> outputFunc(output);
+            auto prevOutputFunc = safeOutputFunc;
+            safeOutputFunc = &outputFunc;
             
             if (!L->errfunc)
             {
@@ -805,7 +803,7 @@ namespace NS_SLUA {
 
                 try
                 {
-                    safeOutputLambda.Execute();
+                    outputFunc();
                 }
                 catch (...)
                 {
@@ -818,6 +816,7 @@ namespace NS_SLUA {
 
                 L->errfunc = errfunc;
             }
+            safeOutputFunc = prevOutputFunc;
         }
 
         // pop returned value
@@ -827,7 +826,7 @@ namespace NS_SLUA {
 
     int LuaVar::safeOutput(lua_State* L)
     {
-        safeOutputLambda.Execute();
+        (*safeOutputFunc)();
         return 0;
     }
 
@@ -844,15 +843,28 @@ namespace NS_SLUA {
             tv.d = ov.d;
             break;
         case LV_STRING:
-            tv.s = ov.s;
-            tv.s->addRef();
+            tv.inlineLen = ov.inlineLen;
+            if(ov.inlineLen)
+                FMemory::Memcpy(tv.str,ov.str,ov.inlineLen);
+            else {
+                tv.s = ov.s;
+                tv.s->addRef();
+            }
             break;
         case LV_FUNCTION:
         case LV_TABLE:
-        case LV_USERDATA:
-            tv.ref = ov.ref;
-            tv.ref->addRef();
+        case LV_USERDATA: {
+            // each var owns its slot, copy value to another one
+            auto state = LuaState::isValid(stateIndex) ? LuaState::get(stateIndex) : nullptr;
+            if(state && ov.ref!=LUA_NOREF) {
+                auto L = state->getLuaState();
+                lua_rawgeti(L,LUA_REGISTRYINDEX,ov.ref);
+                tv.ref = state->refValue(L);
+            }
+            else
+                tv.ref = LUA_NOREF;
             break;
+        }
         case LV_LIGHTUD:
             tv.ptr = ov.ptr;
             break;
@@ -866,11 +878,10 @@ namespace NS_SLUA {
 
     void LuaVar::clone(const LuaVar& other) {
         stateIndex = other.stateIndex;
-        numOfVar = other.numOfVar;
-        if(numOfVar>0 && other.vars) {
-            vars = new lua_var[numOfVar];
+        if(other.numOfVar>0) {
+            alloc(other.numOfVar);
             for(size_t n=0;n<numOfVar;n++) {
-                varClone( vars[n], other.vars[n] );
+                varClone( getVars()[n], other.getVars()[n] );
             }
         }
     }
@@ -878,7 +889,12 @@ namespace NS_SLUA {
     void LuaVar::move(LuaVar&& other) {
         stateIndex = other.stateIndex;
         numOfVar = other.numOfVar;
-        vars = other.vars;
+        if(numOfVar==1) {
+            inlineVar = other.inlineVar;
+            vars = nullptr;
+        }
+        else
+            vars = other.vars;
 
         other.numOfVar = 0;
         other.vars = nullptr;
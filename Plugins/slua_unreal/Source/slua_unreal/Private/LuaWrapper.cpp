@@ -13,6 +13,7 @@
 
 #include "LuaWrapper.h"
 #include "LuaObject.h"
+#include "HAL/IConsoleManager.h"
 
 #define SLUA_GCSTRUCT(typeName) auto flag = udptr->flag; \
                     if (udptr->parent) { \
@@ -24,6 +25,19 @@
                     if ((flag & UD_AUTOGC) && !(flag & UD_HADFREE)) delete self
 
 namespace NS_SLUA {
+
+    static int32 InlineValueType = 0;
+    FAutoConsoleVariableRef CVarSluaInlineValueType(
+        TEXT("slua.InlineValueType"),
+        InlineValueType,
+        TEXT("Store new FVector and FRotator in lua userdata without heap object.\n"),
+        ECVF_Default);
+
+    LuaWrapper::ValueTypeStats LuaWrapper::valueTypeStats = { 0, 0 };
+
+    bool LuaWrapper::isInlineValueType() {
+        return !!InlineValueType;
+    }
  
     static UScriptStruct* FRotatorStruct = nullptr;
     static UScriptStruct* FTransformStruct = nullptr;
@@ -49,14 +63,21 @@ namespace NS_SLUA {
     TMap<UScriptStruct*, pushStructFunction> _pushStructMap;
     TMap<UScriptStruct*, checkStructFunction> _checkStructMap;
 
-    static inline FRotator* __newFRotator() {
-        return new FRotator();
+    // push new value, stored in userdata if inline value type enabled
+    static inline FRotator* __newFRotator(lua_State* L) {
+        if (LuaWrapper::isInlineValueType()) {
+            LuaWrapper::valueTypeStats.inlined++;
+            return LuaObject::pushInline<FRotator>(L, "FRotator");
+        }
+        LuaWrapper::valueTypeStats.heap++;
+        auto ptr = new FRotator();
+        LuaObject::push<FRotator>(L, "FRotator", ptr, UD_AUTOGC | UD_VALUETYPE);
+        return ptr;
     }
 
     static void __pushFRotator(lua_State* L, FStructProperty* p, uint8* parms) {
-        auto ptr = __newFRotator();
+        auto ptr = __newFRotator(L);
         p->CopyCompleteValue(ptr, parms);
-        LuaObject::push<FRotator>(L, "FRotator", ptr, UD_AUTOGC | UD_VALUETYPE);
     }
 
     static void* __checkFRotator(lua_State* L, FStructProperty* p, uint8* parms, int i) {
@@ -129,14 +150,21 @@ namespace NS_SLUA {
         return v;
     }
 
-    static inline FVector* __newFVector() {
-        return new FVector();
+    // push new value, stored in userdata if inline value type enabled
+    static inline FVector* __newFVector(lua_State* L) {
+        if (LuaWrapper::isInlineValueType()) {
+            LuaWrapper::valueTypeStats.inlined++;
+            return LuaObject::pushInline<FVector>(L, "FVector");
+        }
+        LuaWrapper::valueTypeStats.heap++;
+        auto ptr = new FVector();
+        LuaObject::push<FVector>(L, "FVector", ptr, UD_AUTOGC | UD_VALUETYPE);
+        return ptr;
     }
 
     static void __pushFVector(lua_State* L, FStructProperty* p, uint8* parms) {
-        auto ptr = __newFVector();
+        auto ptr = __newFVector(L);
         p->CopyCompleteValue(ptr, parms);
-        LuaObject::push<FVector>(L, "FVector", ptr, UD_AUTOGC | UD_VALUETYPE);
     }
 
     static void* __checkFVector(lua_State* L, FStructProperty* p, uint8* parms, int i) {
@@ -394,22 +422,21 @@ namespace NS_SLUA {
         static int __ctor(lua_State* L) {
             auto argc = lua_gettop(L);
             if (argc == 1) {
-                auto self = new FRotator();
-                LuaObject::push<FRotator>(L, "FRotator", self, UD_AUTOGC | UD_VALUETYPE);
+                auto self = __newFRotator(L);
                 return 1;
             }
             if (argc == 2) {
                 auto InF = LuaObject::checkValue<float>(L, 2);
-                auto self = new FRotator(InF);
-                LuaObject::push<FRotator>(L, "FRotator", self, UD_AUTOGC | UD_VALUETYPE);
+                auto self = __newFRotator(L);
+                *self = FRotator(InF);
                 return 1;
             }
             if (argc == 4) {
                 auto InPitch = LuaObject::checkValue<float>(L, 2);
                 auto InYaw = LuaObject::checkValue<float>(L, 3);
                 auto InRoll = LuaObject::checkValue<float>(L, 4);
-                auto self = new FRotator(InPitch, InYaw, InRoll);
-                LuaObject::push<FRotator>(L, "FRotator", self, UD_AUTOGC | UD_VALUETYPE);
+                auto self = __newFRotator(L);
+                *self = FRotator(InPitch, InYaw, InRoll);
                 return 1;
             }
             luaL_error(L, "call FRotator() error, argc=%d", argc);
@@ -431,9 +458,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& RRef = *R;
-                auto ret = __newFRotator();
+                auto ret = __newFRotator(L);
                 *ret = (*self + RRef);
-                LuaObject::push<FRotator>(L, "FRotator", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "FRotator operator__add error, arg=%d", lua_typename(L, 2));
@@ -449,9 +475,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& RRef = *R;
-                auto ret = __newFRotator();
+                auto ret = __newFRotator(L);
                 *ret = (*self - RRef);
-                LuaObject::push<FRotator>(L, "FRotator", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "FRotator operator__sub error, arg=%d", lua_typename(L, 2));
@@ -462,9 +487,8 @@ namespace NS_SLUA {
             CheckSelf(FRotator);
             if (lua_isnumber(L, 2)) {
                 auto Scale = LuaObject::checkValue<float>(L, 2);
-                auto ret = __newFRotator();
+                auto ret = __newFRotator(L);
                 *ret = (*self * Scale);
-                LuaObject::push<FRotator>(L, "FRotator", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "FRotator operator__mul error, arg=%d", lua_typename(L, 2));
@@ -488,6 +512,49 @@ namespace NS_SLUA {
             return 1;
         }
 
+        // in place version of Add, return self
+        static int AddInPlace(lua_State* L) {
+            CheckSelf(FRotator);
+            auto R = LuaObject::checkValue<FRotator*>(L, 2);
+            if (!R) {
+                luaL_error(L, "%s argument 2 is nullptr", __FUNCTION__);
+                return 0;
+            }
+            *self += *R;
+            lua_settop(L, 1);
+            return 1;
+        }
+
+        // in place version of Sub, return self
+        static int SubInPlace(lua_State* L) {
+            CheckSelf(FRotator);
+            auto R = LuaObject::checkValue<FRotator*>(L, 2);
+            if (!R) {
+                luaL_error(L, "%s argument 2 is nullptr", __FUNCTION__);
+                return 0;
+            }
+            *self -= *R;
+            lua_settop(L, 1);
+            return 1;
+        }
+
+        static int Set(lua_State* L) {
+            auto argc = lua_gettop(L);
+            if (argc == 4) {
+                CheckSelf(FRotator);
+                auto InPitch = LuaObject::checkValue<float>(L, 2);
+                auto InYaw = LuaObject::checkValue<float>(L, 3);
+                auto InRoll = LuaObject::checkValue<float>(L, 4);
+                self->Pitch = InPitch;
+                self->Yaw = InYaw;
+                self->Roll = InRoll;
+                lua_settop(L, 1);
+                return 1;
+            }
+            luaL_error(L, "call FRotator::Set error, argc=%d", argc);
+            return 0;
+        }
+
         static int get_Pitch(lua_State* L) {
             CheckSelf(FRotator);
             auto& Pitch = self->Pitch;
@@ -611,9 +678,8 @@ namespace NS_SLUA {
                 auto DeltaPitch = LuaObject::checkValue<float>(L, 2);
                 auto DeltaYaw = LuaObject::checkValue<float>(L, 3);
                 auto DeltaRoll = LuaObject::checkValue<float>(L, 4);
-                auto ret = __newFRotator();
+                auto ret = __newFRotator(L);
                 *ret = self->Add(DeltaPitch, DeltaYaw, DeltaRoll);
-                LuaObject::push<FRotator>(L, "FRotator", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRotator::Add error, argc=%d", argc);
@@ -624,9 +690,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FRotator);
-                auto ret = __newFRotator();
+                auto ret = __newFRotator(L);
                 *ret = self->GetInverse();
-                LuaObject::push<FRotator>(L, "FRotator", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRotator::GetInverse error, argc=%d", argc);
@@ -643,9 +708,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& RotGridRef = *RotGrid;
-                auto ret = __newFRotator();
+                auto ret = __newFRotator(L);
                 *ret = self->GridSnap(RotGridRef);
-                LuaObject::push<FRotator>(L, "FRotator", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRotator::GridSnap error, argc=%d", argc);
@@ -656,9 +720,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FRotator);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->Vector();
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRotator::Vector error, argc=%d", argc);
@@ -669,9 +732,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FRotator);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->Euler();
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRotator::Euler error, argc=%d", argc);
@@ -688,9 +750,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->RotateVector(VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRotator::RotateVector error, argc=%d", argc);
@@ -707,9 +768,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->UnrotateVector(VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRotator::UnrotateVector error, argc=%d", argc);
@@ -720,9 +780,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FRotator);
-                auto ret = __newFRotator();
+                auto ret = __newFRotator(L);
                 *ret = self->Clamp();
-                LuaObject::push<FRotator>(L, "FRotator", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRotator::Clamp error, argc=%d", argc);
@@ -733,9 +792,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FRotator);
-                auto ret = __newFRotator();
+                auto ret = __newFRotator(L);
                 *ret = self->GetNormalized();
-                LuaObject::push<FRotator>(L, "FRotator", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRotator::GetNormalized error, argc=%d", argc);
@@ -746,9 +804,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FRotator);
-                auto ret = __newFRotator();
+                auto ret = __newFRotator(L);
                 *ret = self->GetDenormalized();
-                LuaObject::push<FRotator>(L, "FRotator", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRotator::GetDenormalized error, argc=%d", argc);
@@ -951,9 +1008,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& EulerRef = *Euler;
-                auto ret = __newFRotator();
+                auto ret = __newFRotator(L);
                 *ret = FRotator::MakeFromEuler(EulerRef);
-                LuaObject::push<FRotator>(L, "FRotator", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRotator::MakeFromEuler error, argc=%d", argc);
@@ -971,6 +1027,9 @@ namespace NS_SLUA {
             LuaObject::addField(L, "Yaw", get_Yaw, set_Yaw, true);
             LuaObject::addField(L, "Roll", get_Roll, set_Roll, true);
             LuaObject::addField(L, "ZeroRotator", get_ZeroRotator, nullptr, false);
+            LuaObject::addMethod(L, "AddInPlace", AddInPlace, true);
+            LuaObject::addMethod(L, "SubInPlace", SubInPlace, true);
+            LuaObject::addMethod(L, "Set", Set, true);
             LuaObject::addMethod(L, "DiagnosticCheckNaN", DiagnosticCheckNaN, true);
             LuaObject::addMethod(L, "IsNearlyZero", IsNearlyZero, true);
             LuaObject::addMethod(L, "IsZero", IsZero, true);
@@ -1382,9 +1441,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->TransformPosition(VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::TransformPosition error, argc=%d", argc);
@@ -1401,9 +1459,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->TransformPositionNoScale(VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::TransformPositionNoScale error, argc=%d", argc);
@@ -1420,9 +1477,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->InverseTransformPosition(VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::InverseTransformPosition error, argc=%d", argc);
@@ -1439,9 +1495,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->InverseTransformPositionNoScale(VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::InverseTransformPositionNoScale error, argc=%d", argc);
@@ -1458,9 +1513,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->TransformVector(VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::TransformVector error, argc=%d", argc);
@@ -1477,9 +1531,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->TransformVectorNoScale(VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::TransformVectorNoScale error, argc=%d", argc);
@@ -1496,9 +1549,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->InverseTransformVector(VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::InverseTransformVector error, argc=%d", argc);
@@ -1515,9 +1567,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->InverseTransformVectorNoScale(VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::InverseTransformVectorNoScale error, argc=%d", argc);
@@ -1544,9 +1595,8 @@ namespace NS_SLUA {
                 CheckSelf(FTransform);
                 auto InAxis = LuaObject::checkValue<int>(L, 2);
                 auto InAxisVal = (EAxis::Type)InAxis;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetScaledAxis(InAxisVal);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::GetScaledAxis error, argc=%d", argc);
@@ -1559,9 +1609,8 @@ namespace NS_SLUA {
                 CheckSelf(FTransform);
                 auto InAxis = LuaObject::checkValue<int>(L, 2);
                 auto InAxisVal = (EAxis::Type)InAxis;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetUnitAxis(InAxisVal);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::GetUnitAxis error, argc=%d", argc);
@@ -1587,9 +1636,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FTransform);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetLocation();
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::GetLocation error, argc=%d", argc);
@@ -1600,9 +1648,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FTransform);
-                auto ret = __newFRotator();
+                auto ret = __newFRotator(L);
                 *ret = self->Rotator();
-                LuaObject::push<FRotator>(L, "FRotator", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::Rotator error, argc=%d", argc);
@@ -1937,9 +1984,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FTransform);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetTranslation();
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::GetTranslation error, argc=%d", argc);
@@ -1950,9 +1996,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FTransform);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetScale3D();
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::GetScale3D error, argc=%d", argc);
@@ -2026,9 +2071,8 @@ namespace NS_SLUA {
                 }
                 auto& InScaleRef = *InScale;
                 auto Tolerance = LuaObject::checkValue<float>(L, 2);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = FTransform::GetSafeScaleReciprocal(InScaleRef, Tolerance);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::GetSafeScaleReciprocal error, argc=%d", argc);
@@ -2122,9 +2166,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& BRef = *B;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = FTransform::AddTranslations(ARef, BRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::AddTranslations error, argc=%d", argc);
@@ -2146,9 +2189,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& BRef = *B;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = FTransform::SubtractTranslations(ARef, BRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FTransform::SubtractTranslations error, argc=%d", argc);
@@ -3280,30 +3322,29 @@ namespace NS_SLUA {
         static int __ctor(lua_State* L) {
             auto argc = lua_gettop(L);
             if (argc == 1) {
-                auto self = new FVector();
-                LuaObject::push<FVector>(L, "FVector", self, UD_AUTOGC | UD_VALUETYPE);
+                auto self = __newFVector(L);
                 return 1;
             }
             if (argc == 2) {
                 auto InF = LuaObject::checkValue<float>(L, 2);
-                auto self = new FVector(InF);
-                LuaObject::push<FVector>(L, "FVector", self, UD_AUTOGC | UD_VALUETYPE);
+                auto self = __newFVector(L);
+                *self = FVector(InF);
                 return 1;
             }
             if (argc == 3) {
                 auto V = LuaObject::checkValue<FVector2D*>(L, 2);
                 auto VVal = *V;
                 auto InZ = LuaObject::checkValue<float>(L, 3);
-                auto self = new FVector(VVal, InZ);
-                LuaObject::push<FVector>(L, "FVector", self, UD_AUTOGC | UD_VALUETYPE);
+                auto self = __newFVector(L);
+                *self = FVector(VVal, InZ);
                 return 1;
             }
             if (argc == 4) {
                 auto InX = LuaObject::checkValue<float>(L, 2);
                 auto InY = LuaObject::checkValue<float>(L, 3);
                 auto InZ = LuaObject::checkValue<float>(L, 4);
-                auto self = new FVector(InX, InY, InZ);
-                LuaObject::push<FVector>(L, "FVector", self, UD_AUTOGC | UD_VALUETYPE);
+                auto self = __newFVector(L);
+                *self = FVector(InX, InY, InZ);
                 return 1;
             }
             luaL_error(L, "call FVector() error, argc=%d", argc);
@@ -3325,16 +3366,14 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = (*self + VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             if (lua_isnumber(L, 2)) {
                 auto Bias = LuaObject::checkValue<float>(L, 2);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = (*self + Bias);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "FVector operator__add error, arg=%d", lua_typename(L, 2));
@@ -3350,16 +3389,14 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = (*self - VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             if (lua_isnumber(L, 2)) {
                 auto Bias = LuaObject::checkValue<float>(L, 2);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = (*self - Bias);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "FVector operator__sub error, arg=%d", lua_typename(L, 2));
@@ -3370,9 +3407,8 @@ namespace NS_SLUA {
             CheckSelf(FVector);
             if (lua_isnumber(L, 2)) {
                 auto Scale = LuaObject::checkValue<float>(L, 2);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = (*self * Scale);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             if (LuaObject::matchType(L, 2, "FVector")) {
@@ -3382,9 +3418,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = (*self * VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "FVector operator__mul error, arg=%d", lua_typename(L, 2));
@@ -3395,9 +3430,8 @@ namespace NS_SLUA {
             CheckSelf(FVector);
             if (lua_isnumber(L, 2)) {
                 auto Scale = LuaObject::checkValue<float>(L, 2);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = (*self / Scale);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             if (LuaObject::matchType(L, 2, "FVector")) {
@@ -3407,9 +3441,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& VRef = *V;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = (*self / VRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "FVector operator__div error, arg=%d", lua_typename(L, 2));
@@ -3433,6 +3466,51 @@ namespace NS_SLUA {
             return 1;
         }
 
+        // in place version of Add, return self
+        static int AddInPlace(lua_State* L) {
+            CheckSelf(FVector);
+            auto V = LuaObject::checkValue<FVector*>(L, 2);
+            if (!V) {
+                luaL_error(L, "%s argument 2 is nullptr", __FUNCTION__);
+                return 0;
+            }
+            *self += *V;
+            lua_settop(L, 1);
+            return 1;
+        }
+
+        // in place version of Sub, return self
+        static int SubInPlace(lua_State* L) {
+            CheckSelf(FVector);
+            auto V = LuaObject::checkValue<FVector*>(L, 2);
+            if (!V) {
+                luaL_error(L, "%s argument 2 is nullptr", __FUNCTION__);
+                return 0;
+            }
+            *self -= *V;
+            lua_settop(L, 1);
+            return 1;
+        }
+
+        // in place version of __mul, by number or FVector, return self
+        static int MulInPlace(lua_State* L) {
+            CheckSelf(FVector);
+            if (LuaObject::matchType(L, 2, "FVector")) {
+                auto V = LuaObject::checkValue<FVector*>(L, 2);
+                if (!V) {
+                    luaL_error(L, "%s argument 2 is nullptr", __FUNCTION__);
+                    return 0;
+                }
+                *self *= *V;
+            }
+            else {
+                auto Scale = LuaObject::checkValue<float>(L, 2);
+                *self *= Scale;
+            }
+            lua_settop(L, 1);
+            return 1;
+        }
+
         static int get_X(lua_State* L) {
             CheckSelf(FVector);
             auto& X = self->X;
@@ -3674,9 +3752,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& OtherRef = *Other;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->ComponentMin(OtherRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::ComponentMin error, argc=%d", argc);
@@ -3693,9 +3770,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& OtherRef = *Other;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->ComponentMax(OtherRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::ComponentMax error, argc=%d", argc);
@@ -3706,9 +3782,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FVector);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetAbs();
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::GetAbs error, argc=%d", argc);
@@ -3837,9 +3912,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FVector);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetSignVector();
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::GetSignVector error, argc=%d", argc);
@@ -3850,9 +3924,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FVector);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->Projection();
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::Projection error, argc=%d", argc);
@@ -3863,9 +3936,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FVector);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetUnsafeNormal();
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::GetUnsafeNormal error, argc=%d", argc);
@@ -3877,9 +3949,8 @@ namespace NS_SLUA {
             if (argc == 2) {
                 CheckSelf(FVector);
                 auto GridSz = LuaObject::checkValue<float>(L, 2);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GridSnap(GridSz);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::GridSnap error, argc=%d", argc);
@@ -3891,9 +3962,8 @@ namespace NS_SLUA {
             if (argc == 2) {
                 CheckSelf(FVector);
                 auto Radius = LuaObject::checkValue<float>(L, 2);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->BoundToCube(Radius);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::BoundToCube error, argc=%d", argc);
@@ -3906,9 +3976,8 @@ namespace NS_SLUA {
                 CheckSelf(FVector);
                 auto Min = LuaObject::checkValue<float>(L, 2);
                 auto Max = LuaObject::checkValue<float>(L, 3);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetClampedToSize(Min, Max);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::GetClampedToSize error, argc=%d", argc);
@@ -3921,9 +3990,8 @@ namespace NS_SLUA {
                 CheckSelf(FVector);
                 auto Min = LuaObject::checkValue<float>(L, 2);
                 auto Max = LuaObject::checkValue<float>(L, 3);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetClampedToSize2D(Min, Max);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::GetClampedToSize2D error, argc=%d", argc);
@@ -3935,9 +4003,8 @@ namespace NS_SLUA {
             if (argc == 2) {
                 CheckSelf(FVector);
                 auto MaxSize = LuaObject::checkValue<float>(L, 2);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetClampedToMaxSize(MaxSize);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::GetClampedToMaxSize error, argc=%d", argc);
@@ -3949,9 +4016,8 @@ namespace NS_SLUA {
             if (argc == 2) {
                 CheckSelf(FVector);
                 auto MaxSize = LuaObject::checkValue<float>(L, 2);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetClampedToMaxSize2D(MaxSize);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::GetClampedToMaxSize2D error, argc=%d", argc);
@@ -3980,9 +4046,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FVector);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->Reciprocal();
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::Reciprocal error, argc=%d", argc);
@@ -4012,9 +4077,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& MirrorNormalRef = *MirrorNormal;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->MirrorByVector(MirrorNormalRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::MirrorByVector error, argc=%d", argc);
@@ -4032,9 +4096,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& AxisRef = *Axis;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->RotateAngleAxis(AngleDeg, AxisRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::RotateAngleAxis error, argc=%d", argc);
@@ -4046,9 +4109,8 @@ namespace NS_SLUA {
             if (argc == 2) {
                 CheckSelf(FVector);
                 auto Tolerance = LuaObject::checkValue<float>(L, 2);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetSafeNormal(Tolerance);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::GetSafeNormal error, argc=%d", argc);
@@ -4060,9 +4122,8 @@ namespace NS_SLUA {
             if (argc == 2) {
                 CheckSelf(FVector);
                 auto Tolerance = LuaObject::checkValue<float>(L, 2);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetSafeNormal2D(Tolerance);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::GetSafeNormal2D error, argc=%d", argc);
@@ -4093,9 +4154,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& ARef = *A;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->ProjectOnTo(ARef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::ProjectOnTo error, argc=%d", argc);
@@ -4112,9 +4172,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& NormalRef = *Normal;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->ProjectOnToNormal(NormalRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::ProjectOnToNormal error, argc=%d", argc);
@@ -4125,9 +4184,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FVector);
-                auto ret = __newFRotator();
+                auto ret = __newFRotator(L);
                 *ret = self->ToOrientationRotator();
-                LuaObject::push<FRotator>(L, "FRotator", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::ToOrientationRotator error, argc=%d", argc);
@@ -4138,9 +4196,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FVector);
-                auto ret = __newFRotator();
+                auto ret = __newFRotator(L);
                 *ret = self->Rotation();
-                LuaObject::push<FRotator>(L, "FRotator", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::Rotation error, argc=%d", argc);
@@ -4285,9 +4342,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& BRef = *B;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = FVector::CrossProduct(ARef, BRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::CrossProduct error, argc=%d", argc);
@@ -4445,9 +4501,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& PlaneNormalRef = *PlaneNormal;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = FVector::PointPlaneProject(PointRef, PlaneBaseRef, PlaneNormalRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             if (argc == 4) {
@@ -4475,9 +4530,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& CRef = *C;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = FVector::PointPlaneProject(PointRef, ARef, BRef, CRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::PointPlaneProject error, argc=%d", argc);
@@ -4499,9 +4553,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& PlaneNormalRef = *PlaneNormal;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = FVector::VectorPlaneProject(VRef, PlaneNormalRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::VectorPlaneProject error, argc=%d", argc);
@@ -4838,9 +4891,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& RadVectorRef = *RadVector;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = FVector::RadiansToDegrees(RadVectorRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::RadiansToDegrees error, argc=%d", argc);
@@ -4856,9 +4908,8 @@ namespace NS_SLUA {
                     return 0;
                 }
                 auto& DegVectorRef = *DegVector;
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = FVector::DegreesToRadians(DegVectorRef);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector::DegreesToRadians error, argc=%d", argc);
@@ -4881,6 +4932,9 @@ namespace NS_SLUA {
             LuaObject::addField(L, "UpVector", get_UpVector, nullptr, false);
             LuaObject::addField(L, "ForwardVector", get_ForwardVector, nullptr, false);
             LuaObject::addField(L, "RightVector", get_RightVector, nullptr, false);
+            LuaObject::addMethod(L, "AddInPlace", AddInPlace, true);
+            LuaObject::addMethod(L, "SubInPlace", SubInPlace, true);
+            LuaObject::addMethod(L, "MulInPlace", MulInPlace, true);
             LuaObject::addMethod(L, "DiagnosticCheckNaN", DiagnosticCheckNaN, true);
             LuaObject::addMethod(L, "Equals", Equals, true);
             LuaObject::addMethod(L, "AllComponentsEqual", AllComponentsEqual, true);
@@ -5452,9 +5506,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FVector2D);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->SphericalToUnitCartesian();
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FVector2D::SphericalToUnitCartesian error, argc=%d", argc);
@@ -5696,9 +5749,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FRandomStream);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->GetUnitVector();
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRandomStream::GetUnitVector error, argc=%d", argc);
@@ -5774,9 +5826,8 @@ namespace NS_SLUA {
             auto argc = lua_gettop(L);
             if (argc == 1) {
                 CheckSelf(FRandomStream);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->VRand();
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRandomStream::VRand error, argc=%d", argc);
@@ -5794,9 +5845,8 @@ namespace NS_SLUA {
                 }
                 auto& DirRef = *Dir;
                 auto ConeHalfAngleRad = LuaObject::checkValue<float>(L, 3);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->VRandCone(DirRef, ConeHalfAngleRad);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             if (argc == 4) {
@@ -5809,9 +5859,8 @@ namespace NS_SLUA {
                 auto& DirRef = *Dir;
                 auto HorizontalConeHalfAngleRad = LuaObject::checkValue<float>(L, 3);
                 auto VerticalConeHalfAngleRad = LuaObject::checkValue<float>(L, 4);
-                auto ret = __newFVector();
+                auto ret = __newFVector(L);
                 *ret = self->VRandCone(DirRef, HorizontalConeHalfAngleRad, VerticalConeHalfAngleRad);
-                LuaObject::push<FVector>(L, "FVector", ret, UD_AUTOGC | UD_VALUETYPE);
                 return 1;
             }
             luaL_error(L, "call FRandomStream::VRandCone error, argc=%d", argc);
@@ -7319,89 +7368,89 @@ namespace NS_SLUA {
         FRotatorStruct = TBaseStructure<FRotator>::Get();
         _pushStructMap.Add(FRotatorStruct, __pushFRotator);
         _checkStructMap.Add(FRotatorStruct, __checkFRotator);
-        FRotatorWrapper::bind(L);
+        LuaObject::regLazyType(L, "FRotator", FRotatorWrapper::bind);
 
         FTransformStruct = TBaseStructure<FTransform>::Get();
         _pushStructMap.Add(FTransformStruct, __pushFTransform);
         _checkStructMap.Add(FTransformStruct, __checkFTransform);
-        FTransformWrapper::bind(L);
+        LuaObject::regLazyType(L, "FTransform", FTransformWrapper::bind);
 
         FLinearColorStruct = TBaseStructure<FLinearColor>::Get();
         _pushStructMap.Add(FLinearColorStruct, __pushFLinearColor);
         _checkStructMap.Add(FLinearColorStruct, __checkFLinearColor);
-        FLinearColorWrapper::bind(L);
+        LuaObject::regLazyType(L, "FLinearColor", FLinearColorWrapper::bind);
 
         FColorStruct = TBaseStructure<FColor>::Get();
         _pushStructMap.Add(FColorStruct, __pushFColor);
         _checkStructMap.Add(FColorStruct, __checkFColor);
-        FColorWrapper::bind(L);
+        LuaObject::regLazyType(L, "FColor", FColorWrapper::bind);
 
         FVectorStruct = TBaseStructure<FVector>::Get();
         _pushStructMap.Add(FVectorStruct, __pushFVector);
         _checkStructMap.Add(FVectorStruct, __checkFVector);
-        FVectorWrapper::bind(L);
+        LuaObject::regLazyType(L, "FVector", FVectorWrapper::bind);
 
         FVector2DStruct = TBaseStructure<FVector2D>::Get();
         _pushStructMap.Add(FVector2DStruct, __pushFVector2D);
         _checkStructMap.Add(FVector2DStruct, __checkFVector2D);
-        FVector2DWrapper::bind(L);
+        LuaObject::regLazyType(L, "FVector2D", FVector2DWrapper::bind);
 
         FRandomStreamStruct = TBaseStructure<FRandomStream>::Get();
         _pushStructMap.Add(FRandomStreamStruct, __pushFRandomStream);
         _checkStructMap.Add(FRandomStreamStruct, __checkFRandomStream);
-        FRandomStreamWrapper::bind(L);
+        LuaObject::regLazyType(L, "FRandomStream", FRandomStreamWrapper::bind);
 
         FGuidStruct = TBaseStructure<FGuid>::Get();
         _pushStructMap.Add(FGuidStruct, __pushFGuid);
         _checkStructMap.Add(FGuidStruct, __checkFGuid);
-        FGuidWrapper::bind(L);
+        LuaObject::regLazyType(L, "FGuid", FGuidWrapper::bind);
 
         FBox2DStruct = TBaseStructure<FBox2D>::Get();
         _pushStructMap.Add(FBox2DStruct, __pushFBox2D);
         _checkStructMap.Add(FBox2DStruct, __checkFBox2D);
-        FBox2DWrapper::bind(L);
+        LuaObject::regLazyType(L, "FBox2D", FBox2DWrapper::bind);
 
         FFloatRangeBoundStruct = TBaseStructure<FFloatRangeBound>::Get();
         _pushStructMap.Add(FFloatRangeBoundStruct, __pushFFloatRangeBound);
         _checkStructMap.Add(FFloatRangeBoundStruct, __checkFFloatRangeBound);
-        FFloatRangeBoundWrapper::bind(L);
+        LuaObject::regLazyType(L, "FFloatRangeBound", FFloatRangeBoundWrapper::bind);
 
         FFloatRangeStruct = TBaseStructure<FFloatRange>::Get();
         _pushStructMap.Add(FFloatRangeStruct, __pushFFloatRange);
         _checkStructMap.Add(FFloatRangeStruct, __checkFFloatRange);
-        FFloatRangeWrapper::bind(L);
+        LuaObject::regLazyType(L, "FFloatRange", FFloatRangeWrapper::bind);
 
         FInt32RangeBoundStruct = TBaseStructure<FInt32RangeBound>::Get();
         _pushStructMap.Add(FInt32RangeBoundStruct, __pushFInt32RangeBound);
         _checkStructMap.Add(FInt32RangeBoundStruct, __checkFInt32RangeBound);
-        FInt32RangeBoundWrapper::bind(L);
+        LuaObject::regLazyType(L, "FInt32RangeBound", FInt32RangeBoundWrapper::bind);
 
         FInt32RangeStruct = TBaseStructure<FInt32Range>::Get();
         _pushStructMap.Add(FInt32RangeStruct, __pushFInt32Range);
         _checkStructMap.Add(FInt32RangeStruct, __checkFInt32Range);
-        FInt32RangeWrapper::bind(L);
+        LuaObject::regLazyType(L, "FInt32Range", FInt32RangeWrapper::bind);
 
         FFloatIntervalStruct = TBaseStructure<FFloatInterval>::Get();
         _pushStructMap.Add(FFloatIntervalStruct, __pushFFloatInterval);
         _checkStructMap.Add(FFloatIntervalStruct, __checkFFloatInterval);
-        FFloatIntervalWrapper::bind(L);
+        LuaObject::regLazyType(L, "FFloatInterval", FFloatIntervalWrapper::bind);
 
         FInt32IntervalStruct = TBaseStructure<FInt32Interval>::Get();
         _pushStructMap.Add(FInt32IntervalStruct, __pushFInt32Interval);
         _checkStructMap.Add(FInt32IntervalStruct, __checkFInt32Interval);
-        FInt32IntervalWrapper::bind(L);
+        LuaObject::regLazyType(L, "FInt32Interval", FInt32IntervalWrapper::bind);
 
         FPrimaryAssetTypeStruct = TBaseStructure<FPrimaryAssetType>::Get();
         _pushStructMap.Add(FPrimaryAssetTypeStruct, __pushFPrimaryAssetType);
         _checkStructMap.Add(FPrimaryAssetTypeStruct, __checkFPrimaryAssetType);
-        FPrimaryAssetTypeWrapper::bind(L);
+        LuaObject::regLazyType(L, "FPrimaryAssetType", FPrimaryAssetTypeWrapper::bind);
 
         FPrimaryAssetIdStruct = TBaseStructure<FPrimaryAssetId>::Get();
         _pushStructMap.Add(FPrimaryAssetIdStruct, __pushFPrimaryAssetId);
         _checkStructMap.Add(FPrimaryAssetIdStruct, __checkFPrimaryAssetId);
-        FPrimaryAssetIdWrapper::bind(L);
+        LuaObject::regLazyType(L, "FPrimaryAssetId", FPrimaryAssetIdWrapper::bind);
 
-        FSoftObjectPtrWrapper::bind(L);
+        LuaObject::regLazyType(L, "FSoftObjectPtr", FSoftObjectPtrWrapper::bind);
     }
 
 }
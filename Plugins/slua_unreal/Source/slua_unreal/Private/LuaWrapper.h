@@ -24,6 +24,14 @@ namespace NS_SLUA {
         static int pushValue(lua_State* L, FStructProperty* p, UScriptStruct* uss, uint8* parms);
         static void* checkValue(lua_State* L, FStructProperty* p, UScriptStruct* uss, uint8* parms, int i);
 
+        // FVector and FRotator stored in userdata instead of heap, see slua.InlineValueType
+        static bool isInlineValueType();
+        struct ValueTypeStats {
+            uint64 heap;
+            uint64 inlined;
+        };
+        static ValueTypeStats valueTypeStats;
+
     };
 
 }
@@ -20,6 +20,10 @@
 #include "Blueprint/UserWidget.h"
 #include "Misc/AssertionMacros.h"
 #include "LuaDelegate.h"
+#include "LuaAllocator.h"
+#include "LuaStructPool.h"
+#include "LuaObjectCache.h"
+#include "LuaWrapper.h"
 
 #if WITH_EDITOR
 // Fix compile issue when using unity build
@@ -42,6 +46,20 @@
 #endif
 
 namespace NS_SLUA {
+
+    // accessors resolved by slua.fieldList, names are kept in uservalue
+    struct LuaFieldList {
+        TWeakObjectPtr<UStruct> owner;
+        TArray<LuaPropAccessor> fields;
+
+        static int gc(lua_State* L) {
+            CheckUDGC(LuaFieldList, L, 1);
+            delete UD;
+            return 0;
+        }
+    };
+
+    DefTypeName(LuaFieldList);
     
     void SluaUtil::openLib(lua_State* L) {
         lua_newtable(L);
@@ -56,10 +74,17 @@ namespace NS_SLUA {
         RegMetaMethod(L, getMiliseconds);
         RegMetaMethod(L, getGStartTime);
         RegMetaMethod(L, setGCParam);
+        RegMetaMethod(L, setGCPacer);
+        RegMetaMethod(L, getGCStats);
+        RegMetaMethod(L, getInitStats);
+        RegMetaMethod(L, getValueTypeStats);
         RegMetaMethod(L, dumpUObjects);
         RegMetaMethod(L, getAllWidgetObjects);
         RegMetaMethod(L, isValid);
         RegMetaMethod(L, isStruct);
+        RegMetaMethod(L, fieldList);
+        RegMetaMethod(L, getProps);
+        RegMetaMethod(L, setProps);
         RegMetaMethod(L, addRef);
         RegMetaMethod(L, removeRef);
         RegMetaMethod(L, removeDelegate);
@@ -243,6 +268,114 @@ namespace NS_SLUA {
         return 0;
     }
 
+    int SluaUtil::setGCPacer(lua_State* L)
+    {
+        double frameBudget = lua_tonumber(L, 1);
+        int targetHeapKB = lua_tointeger(L, 2);
+        double frameTime = lua_tonumber(L, 3);
+        LuaState* luaState = LuaState::get(L);
+        luaState->setGCPacer(frameBudget, targetHeapKB, frameTime);
+        return 0;
+    }
+
+    int SluaUtil::getGCStats(lua_State* L)
+    {
+        LuaState* luaState = LuaState::get(L);
+        auto& stats = luaState->getGCPacerStats();
+        lua_newtable(L);
+        lua_pushinteger(L, stats.frames);
+        lua_setfield(L, -2, "frames");
+        lua_pushinteger(L, stats.overBudgetFrames);
+        lua_setfield(L, -2, "overBudgetFrames");
+        lua_pushinteger(L, stats.steps);
+        lua_setfield(L, -2, "steps");
+        lua_pushinteger(L, stats.cycles);
+        lua_setfield(L, -2, "cycles");
+        lua_pushnumber(L, stats.budget);
+        lua_setfield(L, -2, "budget");
+        lua_pushnumber(L, stats.lastCost);
+        lua_setfield(L, -2, "lastCost");
+        lua_pushnumber(L, stats.maxCost);
+        lua_setfield(L, -2, "maxCost");
+        lua_pushnumber(L, stats.avgCost);
+        lua_setfield(L, -2, "avgCost");
+        lua_pushnumber(L, stats.allocRate);
+        lua_setfield(L, -2, "allocRate");
+        lua_pushinteger(L, stats.heapKB);
+        lua_setfield(L, -2, "heapKB");
+        lua_pushinteger(L, stats.stepKB);
+        lua_setfield(L, -2, "stepKB");
+        lua_pushinteger(L, stats.pause);
+        lua_setfield(L, -2, "pause");
+        lua_pushinteger(L, stats.stepmul);
+        lua_setfield(L, -2, "stepmul");
+
+        auto& structStats = luaState->getDeferGCStructStats();
+        lua_pushinteger(L, structStats.gameThreadFreed);
+        lua_setfield(L, -2, "structGameThreadFreed");
+        lua_pushinteger(L, structStats.workerFreed);
+        lua_setfield(L, -2, "structWorkerFreed");
+        lua_pushinteger(L, structStats.backlog);
+        lua_setfield(L, -2, "structBacklog");
+        lua_pushinteger(L, structStats.maxBacklog);
+        lua_setfield(L, -2, "structMaxBacklog");
+        lua_pushinteger(L, structStats.workerPending);
+        lua_setfield(L, -2, "structWorkerPending");
+
+        auto& poolStats = luaState->getStructPool()->getStats();
+        lua_pushinteger(L, poolStats.hits);
+        lua_setfield(L, -2, "structPoolHits");
+        lua_pushinteger(L, poolStats.misses);
+        lua_setfield(L, -2, "structPoolMisses");
+        lua_pushinteger(L, poolStats.bypass);
+        lua_setfield(L, -2, "structPoolBypass");
+        lua_pushinteger(L, poolStats.live);
+        lua_setfield(L, -2, "structPoolLive");
+        lua_pushinteger(L, poolStats.maxLive);
+        lua_setfield(L, -2, "structPoolMaxLive");
+        lua_pushinteger(L, poolStats.idle);
+        lua_setfield(L, -2, "structPoolIdle");
+        lua_pushinteger(L, poolStats.maxIdle);
+        lua_setfield(L, -2, "structPoolMaxIdle");
+
+        if (auto objCache = luaState->getObjectCache()) {
+            auto& cacheStats = objCache->getStats();
+            lua_pushinteger(L, cacheStats.hits);
+            lua_setfield(L, -2, "objCacheHits");
+            lua_pushinteger(L, cacheStats.misses);
+            lua_setfield(L, -2, "objCacheMisses");
+            lua_pushinteger(L, cacheStats.live);
+            lua_setfield(L, -2, "objCacheLive");
+            lua_pushinteger(L, cacheStats.maxLive);
+            lua_setfield(L, -2, "objCacheMaxLive");
+            lua_pushinteger(L, cacheStats.pages);
+            lua_setfield(L, -2, "objCachePages");
+        }
+        return 1;
+    }
+
+    int SluaUtil::getInitStats(lua_State* L)
+    {
+        auto& stats = LuaState::get(L)->getInitStats();
+        lua_newtable(L);
+        lua_pushnumber(L, stats.seconds);
+        lua_setfield(L, -2, "seconds");
+        lua_pushinteger(L, stats.heapKB);
+        lua_setfield(L, -2, "heapKB");
+        return 1;
+    }
+
+    int SluaUtil::getValueTypeStats(lua_State* L)
+    {
+        auto& stats = LuaWrapper::valueTypeStats;
+        lua_newtable(L);
+        lua_pushinteger(L, stats.heap);
+        lua_setfield(L, -2, "heap");
+        lua_pushinteger(L, stats.inlined);
+        lua_setfield(L, -2, "inlined");
+        return 1;
+    }
+
     int SluaUtil::dumpUObjects(lua_State * L)
     {
         auto state = LuaState::get(L);
@@ -319,6 +452,148 @@ namespace NS_SLUA {
         return LuaObject::push(L, false);
     }
 
+    // memory and type of UObject or UStruct instance at p
+    static uint8* checkPropsParent(lua_State* L, int p, UStruct*& cls) {
+        auto ud = (GenericUserData*)lua_touserdata(L, p);
+        if (ud && (ud->flag & UD_USTRUCT)) {
+            LuaStruct* ls = LuaObject::checkValue<LuaStruct*>(L, p);
+            cls = ls->uss;
+            return ls->buf;
+        }
+        UObject* obj = LuaObject::checkValue<UObject*>(L, p);
+        if (!obj) luaL_error(L, "arg %d expect UObject or UStruct", p);
+        cls = obj->GetClass();
+        return (uint8*)obj;
+    }
+
+    static LuaFieldList* checkFieldList(lua_State* L, int p, UStruct* cls) {
+        if (lua_type(L, p) != LUA_TUSERDATA)
+            return nullptr;
+        auto fields = LuaObject::checkUD<LuaFieldList>(L, p);
+        UStruct* owner = fields->owner.Get();
+        if (!owner || !cls->IsChildOf(owner))
+            luaL_error(L, "field list can't be used with %s", TCHAR_TO_UTF8(*cls->GetName()));
+        return fields;
+    }
+
+    // value of accessor at top, reference properties go to __index
+    static void pushProp(lua_State* L, int obj, const LuaPropAccessor* accessor, uint8* parent, int key) {
+        if (!accessor || !accessor->pusher || (accessor->flags & LuaPropAccessor::Reference)) {
+            lua_pushvalue(L, key);
+            lua_gettable(L, obj);
+        }
+        else
+            accessor->pusher(L, accessor->prop, parent + accessor->offset, nullptr);
+    }
+
+    static void checkProp(lua_State* L, int obj, const LuaPropAccessor* accessor, uint8* parent, int key, int value) {
+        if (!accessor || !accessor->checker || (accessor->flags & LuaPropAccessor::ReadOnly)) {
+            lua_pushvalue(L, key);
+            lua_pushvalue(L, value);
+            lua_settable(L, obj);
+        }
+        else
+            accessor->checker(L, accessor->prop, parent + accessor->offset, value, true);
+    }
+
+    int SluaUtil::fieldList(lua_State* L)
+    {
+        UStruct* cls = nullptr;
+        checkPropsParent(L, 1, cls);
+        luaL_checktype(L, 2, LUA_TTABLE);
+
+        auto fields = new LuaFieldList();
+        fields->owner = cls;
+        int n = (int)lua_rawlen(L, 2);
+        lua_createtable(L, n, 0);
+        for (int i = 1; i <= n; i++) {
+            if (lua_rawgeti(L, 2, i) != LUA_TSTRING) {
+                delete fields;
+                luaL_error(L, "field %d expect string, but got %s", i, luaL_typename(L, -1));
+            }
+            // UFunction, extension field or anything else goes to __index/__newindex by name
+            if (auto accessor = LuaObject::findAccessor(L, cls, lua_gettop(L)))
+                fields->fields.Add(*accessor);
+            else {
+                LuaPropAccessor byName;
+                FMemory::Memzero(byName);
+                fields->fields.Add(byName);
+            }
+            lua_rawseti(L, -2, i);
+        }
+
+        LuaObject::pushType(L, fields, "LuaFieldList", nullptr, LuaFieldList::gc);
+        lua_insert(L, -2);
+        lua_setuservalue(L, -2);
+        return 1;
+    }
+
+    int SluaUtil::getProps(lua_State* L)
+    {
+        UStruct* cls = nullptr;
+        uint8* parent = checkPropsParent(L, 1, cls);
+        auto fields = checkFieldList(L, 2, cls);
+        if (fields)
+            lua_getuservalue(L, 2);
+        else {
+            luaL_checktype(L, 2, LUA_TTABLE);
+            lua_pushvalue(L, 2);
+        }
+        int names = lua_gettop(L);
+        int n = fields ? fields->fields.Num() : (int)lua_rawlen(L, names);
+
+        // fill table passed by caller if any, no allocation if keys exist
+        if (lua_istable(L, 3))
+            lua_pushvalue(L, 3);
+        else
+            lua_createtable(L, 0, n);
+        int out = lua_gettop(L);
+
+        for (int i = 0; i < n; i++) {
+            lua_rawgeti(L, names, i + 1);
+            int key = lua_gettop(L);
+            const LuaPropAccessor* accessor = fields ? &fields->fields[i]
+                : (lua_type(L, key) == LUA_TSTRING ? LuaObject::findAccessor(L, cls, key) : nullptr);
+            pushProp(L, 1, accessor, parent, key);
+            lua_rawset(L, out);
+        }
+        return 1;
+    }
+
+    int SluaUtil::setProps(lua_State* L)
+    {
+        UStruct* cls = nullptr;
+        uint8* parent = checkPropsParent(L, 1, cls);
+        luaL_checktype(L, 2, LUA_TTABLE);
+        auto fields = checkFieldList(L, 3, cls);
+
+        if (fields) {
+            // only fields in list, nil value is skipped
+            lua_getuservalue(L, 3);
+            int names = lua_gettop(L);
+            for (int i = 0; i < fields->fields.Num(); i++) {
+                lua_rawgeti(L, names, i + 1);
+                lua_pushvalue(L, -1);
+                lua_rawget(L, 2);
+                int value = lua_gettop(L);
+                if (!lua_isnil(L, value))
+                    checkProp(L, 1, &fields->fields[i], parent, value - 1, value);
+                lua_pop(L, 2);
+            }
+            return 0;
+        }
+
+        lua_pushnil(L);
+        while (lua_next(L, 2)) {
+            int value = lua_gettop(L);
+            int key = value - 1;
+            auto accessor = lua_type(L, key) == LUA_TSTRING ? LuaObject::findAccessor(L, cls, key) : nullptr;
+            checkProp(L, 1, accessor, parent, key, value);
+            lua_pop(L, 1);
+        }
+        return 0;
+    }
+
     int SluaUtil::addRef(lua_State* L)
     {
         luaL_checktype(L, 1, LUA_TUSERDATA);
@@ -427,6 +702,115 @@ namespace NS_SLUA {
         ECVF_Cheat);
 #endif
 
+#if !UE_BUILD_SHIPPING
+    void dumpGCStats() {
+        auto state = LuaState::get();
+        if (!state) return;
+        auto& stats = state->getGCPacerStats();
+        UE_LOG(Slua, Log, TEXT("GC pacer frames %llu, over budget %llu, steps %llu, cycles %llu"),
+            stats.frames, stats.overBudgetFrames, stats.steps, stats.cycles);
+        UE_LOG(Slua, Log, TEXT("GC pacer budget %.3fms, last %.3fms, avg %.3fms, max %.3fms"),
+            stats.budget * 1000.0, stats.lastCost * 1000.0, stats.avgCost * 1000.0, stats.maxCost * 1000.0);
+        UE_LOG(Slua, Log, TEXT("GC pacer heap %d kb, alloc %.1f kb/s, step %d kb, pause %d, stepmul %d"),
+            stats.heapKB, stats.allocRate / 1024.0, stats.stepKB, stats.pause, stats.stepmul);
+
+        auto& structStats = state->getDeferGCStructStats();
+        UE_LOG(Slua, Log, TEXT("Defer gc struct game thread %llu, worker %llu, backlog %d, max backlog %d, worker pending %d"),
+            structStats.gameThreadFreed, structStats.workerFreed, structStats.backlog,
+            structStats.maxBacklog, structStats.workerPending);
+        state->getStructPool()->dumpStats();
+        if (auto objCache = state->getObjectCache())
+            objCache->dumpStats();
+    }
+
+    static FAutoConsoleCommand CVarGCStats(
+        TEXT("slua.GCStats"),
+        TEXT("Print gc pacer, defer gc struct, struct pool and object cache stats of main state"),
+        FConsoleCommandDelegate::CreateStatic(dumpGCStats),
+        ECVF_Cheat);
+
+    void dumpAllocStats() {
+        auto state = LuaState::get();
+        if (!state) return;
+        auto allocator = state->getAllocator();
+        if (!allocator) {
+            UE_LOG(Slua, Log, TEXT("Main state doesn't use size class allocator, set slua.SizeClassAlloc 1 before state created"));
+            return;
+        }
+        allocator->dumpStats();
+    }
+
+    static FAutoConsoleCommand CVarDumpAllocStats(
+        TEXT("slua.DumpAllocStats"),
+        TEXT("Print size class allocator alloc/free histogram of main state"),
+        FConsoleCommandDelegate::CreateStatic(dumpAllocStats),
+        ECVF_Cheat);
+
+    void dumpScriptCallSites(const TArray<FString>& args) {
+        auto state = LuaState::get();
+        if (!state) return;
+        auto check = state->getDeadLoopCheck();
+        if (!check) {
+            UE_LOG(Slua, Log, TEXT("Script watchdog is off, set slua.ScriptWatchdog 1 before state created"));
+            return;
+        }
+        check->dumpCallSites();
+        if (args.Num() > 0 && args[0] == TEXT("clear"))
+            check->clearCallSites();
+    }
+
+    static FAutoConsoleCommand CVarDumpScriptCallSites(
+        TEXT("slua.DumpScriptCallSites"),
+        TEXT("Print long running script calls of main state by call site. Args: [clear]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(dumpScriptCallSites),
+        ECVF_Cheat);
+
+    // cold init and require modules vs init from template of main state
+    void benchStateTemplate(const TArray<FString>& args) {
+        auto mainState = LuaState::get();
+        if (!mainState) return;
+        int count = args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*args[0])) : 10;
+
+        double start = FPlatformTime::Seconds();
+        auto tmpl = mainState->makeTemplate();
+        double makeCost = FPlatformTime::Seconds() - start;
+
+        double cost[2] = { 0.0, 0.0 };
+        int64 heapKB[2] = { 0, 0 };
+        for (int i = 0; i < count; i++) {
+            for (int pass = 0; pass < 2; pass++) {
+                auto state = new LuaState("SluaBenchState");
+                start = FPlatformTime::Seconds();
+                if (pass == 0) {
+                    state->setLoadFileDelegate(tmpl->loadFileDelegate);
+                    state->setLoadFileSpanDelegate(tmpl->loadFileSpanDelegate);
+                    state->init();
+                    for (auto& m : tmpl->modules)
+                        state->requireModule(TCHAR_TO_UTF8(*m.name));
+                }
+                else
+                    state->initFromTemplate(tmpl);
+                cost[pass] += FPlatformTime::Seconds() - start;
+
+                lua_State* L = state->getLuaState();
+                lua_gc(L, LUA_GCCOLLECT, 0);
+                heapKB[pass] += lua_gc(L, LUA_GCCOUNT, 0);
+                delete state;
+            }
+        }
+
+        UE_LOG(Slua, Log, TEXT("State template of %d modules made in %.3fms"), tmpl->modules.Num(), makeCost * 1000.0);
+        UE_LOG(Slua, Log, TEXT("Cold init: %.3fms, heap %lld kb per state"), cost[0] * 1000.0 / count, heapKB[0] / count);
+        UE_LOG(Slua, Log, TEXT("From template: %.3fms, heap %lld kb per state"), cost[1] * 1000.0 / count, heapKB[1] / count);
+    }
+
+    static FAutoConsoleCommand CVarBenchStateTemplate(
+        TEXT("slua.BenchStateTemplate"),
+        TEXT("Create states by cold init and from template of main state, print time and heap. Args: [count]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(benchStateTemplate),
+        ECVF_Cheat);
+#endif
+
 #if WITH_EDITOR
     void dumpUObjects() {
         auto state = LuaState::get();
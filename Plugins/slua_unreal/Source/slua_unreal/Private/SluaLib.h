@@ -36,6 +36,10 @@ namespace NS_SLUA {
         static int getGStartTime(lua_State* L);
 
         static int setGCParam(lua_State* L);
+        static int setGCPacer(lua_State* L);
+        static int getGCStats(lua_State* L);
+        static int getInitStats(lua_State* L);
+        static int getValueTypeStats(lua_State* L);
 
         // dump all uobject that referenced by lua
         static int dumpUObjects(lua_State* L);
@@ -46,6 +50,12 @@ namespace NS_SLUA {
         // return whether an userdata is LuaStruct?
         static int isStruct(lua_State* L);
 
+        // resolve property names of an UObject or UStruct instance once
+        static int fieldList(lua_State* L);
+        // get/set many properties in one call, by field list or array of names
+        static int getProps(lua_State* L);
+        static int setProps(lua_State* L);
+
         static int addRef(lua_State* L);
         static int removeRef(lua_State * L);
         
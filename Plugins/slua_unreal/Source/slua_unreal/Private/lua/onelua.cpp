@@ -0,0 +1,62 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+// build the lua vm from External/lua as a single translation unit,
+// so the module always links against the same sources its headers describe
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable:4244)
+#pragma warning(disable:4456)
+#pragma warning(disable:4457)
+#pragma warning(disable:4702)
+#pragma warning(disable:4996)
+#endif
+
+#include "lua/lapi.cpp"
+#include "lua/lauxlib.cpp"
+#include "lua/lbaselib.cpp"
+#include "lua/lbitlib.cpp"
+#include "lua/lcode.cpp"
+#include "lua/lcorolib.cpp"
+#include "lua/lctype.cpp"
+#include "lua/ldblib.cpp"
+#include "lua/ldebug.cpp"
+#include "lua/ldo.cpp"
+#include "lua/ldump.cpp"
+#include "lua/lfunc.cpp"
+#include "lua/lgc.cpp"
+#include "lua/linit.cpp"
+#include "lua/liolib.cpp"
+#include "lua/llex.cpp"
+#include "lua/lmathlib.cpp"
+#include "lua/lmem.cpp"
+#include "lua/loadlib.cpp"
+#include "lua/lobject.cpp"
+#include "lua/lopcodes.cpp"
+#include "lua/loslib.cpp"
+#include "lua/lparser.cpp"
+#include "lua/lstate.cpp"
+#include "lua/lstring.cpp"
+#include "lua/lstrlib.cpp"
+#include "lua/ltable.cpp"
+#include "lua/ltablib.cpp"
+#include "lua/ltm.cpp"
+#include "lua/lundump.cpp"
+#include "lua/lutf8lib.cpp"
+#include "lua/lvm.cpp"
+#include "lua/lzio.cpp"
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
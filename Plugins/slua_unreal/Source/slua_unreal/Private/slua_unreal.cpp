@@ -14,6 +14,8 @@
 #include "slua_unreal.h"
 
 #include "SluaProfilerDataManager.h"
+#include "LuaScriptPackage.h"
+#include "LuaAllocator.h"
 
 #define LOCTEXT_NAMESPACE "Fslua_unrealModule"
 
@@ -34,6 +36,8 @@ void Fslua_unrealModule::ShutdownModule()
     Simulate.OnShutdownModule();
 #endif
     SluaProfilerDataManager::StopManager();
+    NS_SLUA::LuaScriptPackage::unmountAll();
+    NS_SLUA::LuaAllocator::releaseCachedPages();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,73 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "lua.h"
+
+namespace NS_SLUA {
+
+    // size class allocator for one lua_State
+    // small blocks are carved from per-state pages and recycled by free list of its size class,
+    // lua always tell old size when free or realloc, so no block header needed.
+    // pages are only returned when state closed, so memory keep at high water mark of the state
+    class SLUA_UNREAL_API LuaAllocator {
+    public:
+        static const int NumSizeClasses = 16;
+        // blocks larger than this come from FMemory directly
+        static const uint32 MaxSmallSize = 512;
+        static const uint32 PageSize = 64 * 1024;
+
+        struct Stats {
+            // last slot for large blocks
+            uint64 allocCount[NumSizeClasses + 1];
+            uint64 freeCount[NumSizeClasses + 1];
+            uint64 reallocInPlace;
+            int32 pages;
+            int64 largeBytes;
+        };
+
+        LuaAllocator();
+        ~LuaAllocator();
+
+        // lua_Alloc, ud is LuaAllocator
+        static void* alloc(void* ud, void* ptr, size_t osize, size_t nsize);
+        void* realloc(void* ptr, size_t osize, size_t nsize);
+
+        // call before lua_close, free of small block become no-op,
+        // all pages released at once in destructor
+        void beginBulkRelease();
+
+        // free pages kept for states created later, call on module shutdown
+        static void releaseCachedPages();
+
+        const Stats& getStats() const { return stats; }
+        static uint32 sizeOfClass(int index);
+        void dumpStats() const;
+
+    private:
+        struct SizeClass {
+            void* freeList;
+            uint8* cur;
+            uint8* end;
+        };
+
+        void* allocBlock(size_t size, int sc);
+        void freeBlock(void* ptr, size_t size, int sc);
+
+        SizeClass classes[NumSizeClasses];
+        TArray<void*> pages;
+        Stats stats;
+        bool bulkRelease;
+    };
+}
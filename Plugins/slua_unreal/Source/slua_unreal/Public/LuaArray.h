@@ -22,8 +22,14 @@
 
 namespace NS_SLUA {
 
+    class NewObjectRecorder;
+
     class SLUA_UNREAL_API LuaArray : public FGCObject {
     public:
+        // same as LuaObject::PushPropertyFunction/CheckPropertyFunction
+        typedef int (*ElementPusher)(lua_State* L,FProperty* prop,uint8* parms,NewObjectRecorder* objRecorder);
+        typedef void* (*ElementChecker)(lua_State* L,FProperty* prop,uint8* parms,int i,bool bForceCopy);
+
         static void reg(lua_State* L);
         static void clone(FScriptArray* destArray, FProperty* p, const FScriptArray* srcArray);
         static void clone(FScriptArray* destArray, FArrayProperty* arrayP, const FScriptArray* srcArray);
@@ -46,6 +52,10 @@ namespace NS_SLUA {
             return array;
         }
 
+        FProperty* getInner() const {
+            return inner;
+        }
+
         // Cast FScriptArray to TArray<T> if ElementSize matched
         template<typename T>
         const TArray<T>& asTArray(lua_State* L) const {
@@ -76,18 +86,31 @@ namespace NS_SLUA {
         static int Pairs(lua_State* L);
         static int Enumerable(lua_State* L);
         static int CreateValueTypeObject(lua_State* L);
+        // copy all elements to a new lua table (1-based), or replace all elements by a table
+        static int ToTable(lua_State* L);
+        static int FromTable(lua_State* L);
+        // arr[i] and arr[i]=v, index is 0-based like Get/Set
+        static int Index(lua_State* L);
+        static int NewIndex(lua_State* L);
 
     private:
         FProperty* inner;
         FScriptArray* array;
         bool isRef;
         bool isNewInner;
+        // resolved once from inner, avoid property class lookup per element
+        ElementPusher pusher;
+        ElementChecker checker;
 
+        void resolveElementFunctions();
+        int pushElement(lua_State* L, int index) const;
+        void checkElement(lua_State* L, uint8* dest, int i) const;
         void clear();
         uint8* getRawPtr(int index) const;
         bool isValidIndex(int index) const;
         uint8* insert(int index);
         uint8* add();
+        uint8* addItems(int count);
         void remove(int index);
         int num() const;
         void constructItems(int index,int count);
@@ -95,11 +118,5 @@ namespace NS_SLUA {
 
         static int setupMT(lua_State* L);
         static int gc(lua_State* L);
-
-        struct Enumerator {
-            LuaArray* arr = nullptr;
-            int32 index = 0;
-            static int gc(lua_State* L);
-        };
     };
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "SluaMicro.h"
+#include "lua.h"
+#include "lauxlib.h"
+#include "UObject/UnrealType.h"
+
+namespace NS_SLUA {
+
+    class LuaArray;
+    struct GenericUserData;
+
+    // typed view over LuaArray of numeric element, created by slua.view(arr [, type]),
+    // read and write element memory directly and run kernels in C++ without per element marshal.
+    // view never caches data pointer, so it's safe if array reallocated,
+    // view holds the array in uservalue and links to the owner of array, so it's freed with the owner
+    class SLUA_UNREAL_API LuaArrayView {
+    public:
+        enum ElementType : uint8 {
+            Int8,
+            UInt8,
+            Int16,
+            UInt16,
+            Int32,
+            UInt32,
+            Int64,
+            UInt64,
+            Float,
+            Double,
+            TypeNum,
+        };
+
+        static void reg(lua_State* L);
+        // push view of LuaArray at index p
+        static int push(lua_State* L, int p, ElementType type);
+        // return TypeNum if inner property isn't numeric
+        static ElementType getElementType(FProperty* inner);
+
+    protected:
+        static int __ctor(lua_State* L);
+        static int Index(lua_State* L);
+        static int NewIndex(lua_State* L);
+        static int Num(lua_State* L);
+        static int Type(lua_State* L);
+        // fill(v [, start, count])
+        static int Fill(lua_State* L);
+        // copy(src [, dstStart, srcStart, count]), src is view of same type, overlapped range is ok
+        static int Copy(lua_State* L);
+        // sum/min/max([start, count]), min/max return nil if range is empty
+        static int Sum(lua_State* L);
+        static int Min(lua_State* L);
+        static int Max(lua_State* L);
+        // map(op, v [, start, count]), v is number or view of same type and enough length,
+        // op is add/sub/mul/min/max, div for float, band/bor/bxor for integer
+        static int Map(lua_State* L);
+
+    private:
+        LuaArray* arr;
+        // userdata of arr, check whether freed
+        GenericUserData* arrUD;
+        ElementType type;
+
+        // data and num of array, read on every call
+        uint8* data(lua_State* L, int32& num) const;
+
+        static int setupMT(lua_State* L);
+        static int gc(lua_State* L);
+    };
+}
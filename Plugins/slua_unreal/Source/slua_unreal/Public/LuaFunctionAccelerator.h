@@ -15,12 +15,16 @@
 #include "LuaObject.h"
 
 namespace NS_SLUA {
+    template<typename R, typename... Args>
+    struct CallShape;
+
     class SLUA_UNREAL_API LuaFunctionAccelerator
     {
     public:
         typedef TFunctionRef<void (uint8* params, PTRINT* outParams, NewObjectRecorder* ObjectRecorder)> PostFillParamCallback;
         
         LuaFunctionAccelerator(UFunction* inFunc);
+        ~LuaFunctionAccelerator();
 
         static LuaFunctionAccelerator* findOrAdd(UFunction* inFunc);
         static bool remove(UFunction* inFunc);
@@ -31,13 +35,59 @@ namespace NS_SLUA {
         void fillParam(lua_State* L, int i, NewObjectRecorder* objRecorder, const PostFillParamCallback& callback, bool &isLatentFunction);
         int returnValue(lua_State* L, int i, uint8* params, PTRINT* outParams, NewObjectRecorder* objRecorder);
 
+        // signature of scalar params only can be called by shape thunk, without param buffer walk
+        static const int ShapeMaxArgs = 2;
+        static const int32 ShapeMaxParmsSize = 64;
+        typedef int (*ShapeThunk)(LuaFunctionAccelerator* acc, lua_State* L, int offset, UObject* obj, NewObjectRecorder* objRecorder);
+        bool hasShapeThunk() const { return shapeThunk != nullptr; }
+
+        // flat params to call lua function with params of func, see LuaVar::callByUFunction
+        struct FLuaCallArg
+        {
+            int32 offset;
+            FProperty* prop;
+            LuaObject::PushPropertyFunction pusher;
+            // blueprint const ref, value is in FOutParmRec if given
+            bool bOutParm;
+        };
+        struct FLuaCallResult
+        {
+            int32 offset;
+            FProperty* prop;
+            LuaObject::CheckPropertyFunction checker;
+        };
+        // built on first call from lua side
+        void initLuaCall();
+        bool bLuaCallInit;
+        TArray<FLuaCallArg> luaCallArgs;
+        // return value first, then real out params
+        TArray<FLuaCallResult> luaCallResults;
+
     public:
         UFunction* func;
         const bool bLuaOverride;
 
     protected:
+        template<typename R, typename... Args>
+        friend struct CallShape;
+
         static TMap<UFunction*, LuaFunctionAccelerator*> cache;
 
+        void initShape();
+        void invokeShape(UObject* obj, uint8* params);
+        void initDirectNative();
+        // return -1 if scratch is used by another call or thread
+        int callDirectNative(lua_State* L, int offset, UObject* obj, NewObjectRecorder* objRecorder);
+        // same as UFunction::Invoke, only for native function of non-interface class
+        void invokeNative(UObject* obj, FFrame& stack, uint8* returnValueAddress);
+        ShapeThunk shapeThunk;
+        int32 shapeOffsets[ShapeMaxArgs];
+        // class of object param, to check arg
+        UClass* shapeClasses[ShapeMaxArgs];
+        FProperty* shapeReturnProp;
+        // ParmsSize for native function, PropertiesSize for script function which uses frame as locals
+        int32 shapeFrameSize;
+
         struct AutoDestructor
         {
             AutoDestructor(FProperty** propertys, uint8* params, uint16 numParams)
@@ -97,6 +147,21 @@ namespace NS_SLUA {
         bool bHasReturnParam;
         FPusherInfo returnPusherInfo;
         TArray<FPusherInfo> outPropsPusher;
+
+        // native function with params need no init and destruct, called by native func ptr,
+        // param buffer and out parm list are reused by calls on the thread first called it
+        bool bDirectNative;
+        struct NativeScratch
+        {
+            uint8* params;
+            PTRINT* outParams;
+            FOutParmRec* outParms;
+            uint32 threadId;
+            bool bBusy;
+        };
+        NativeScratch scratch;
+        // offset and size of return value and out params, cleared before each call
+        TArray<TPair<int32, int32>> scratchClears;
     };
     
 }
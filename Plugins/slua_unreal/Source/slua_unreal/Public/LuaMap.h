@@ -19,6 +19,7 @@
 #include "UObject/UnrealType.h"
 #include "UObject/GCObject.h"
 #include "PropertyUtil.h"
+#include "LuaArray.h"
 
 namespace NS_SLUA {
 
@@ -111,6 +112,9 @@ namespace NS_SLUA {
         static int Pairs(lua_State* L);
         static int Enumerable(lua_State* L);
         static int CreateValueTypeObject(lua_State* L);
+        // copy all pairs to a new lua table, or replace all pairs by a table
+        static int ToTable(lua_State* L);
+        static int FromTable(lua_State* L);
 
     private:
         FScriptMap* map;
@@ -119,10 +123,18 @@ namespace NS_SLUA {
         FScriptMapHelper helper;
         bool isRef;
         bool isNewInner;
+        // resolved once from keyProp/valueProp
+        LuaArray::ElementPusher keyPusher;
+        LuaArray::ElementPusher valuePusher;
+        LuaArray::ElementChecker keyChecker;
+        LuaArray::ElementChecker valueChecker;
 
         static int setupMT(lua_State* L);
         static int gc(lua_State* L);
 
+        void resolveElementFunctions();
+        int pushKey(lua_State* L, uint8* keyPtr);
+        int pushValue(lua_State* L, uint8* valuePtr);
         uint8* getKeyPtr(uint8* pairPtr);
         uint8* getValuePtr(uint8* pairPtr);
         void clear();
@@ -132,14 +144,6 @@ namespace NS_SLUA {
         void destructItems(uint8* PairPtr, uint32 Stride, int32 Index, int32 Count, bool bDestroyKeys, bool bDestroyValues);
         bool removePair(const void* KeyPtr);
         void removeAt(int32 Index, int32 Count = 1);
-
-        struct Enumerator {
-            LuaMap* map = nullptr;
-            int32 index = 0;
-            int32 num = 0;
-
-            static int gc(lua_State* L);
-        };
     };
     
 }
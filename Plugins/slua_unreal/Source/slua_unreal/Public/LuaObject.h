@@ -91,6 +91,8 @@ namespace NS_SLUA {
         uint32 size;
         UScriptStruct* uss;
         bool isRef;
+        // size class in LuaStructPool, -1 if not from pool
+        int32 poolClass;
 
         LuaStruct();
         ~LuaStruct();
@@ -119,6 +121,7 @@ namespace NS_SLUA {
     #define UD_WEAKUPTR 1<<8 // flag it's a weak UObject ptr
     #define UD_REFERENCE 1<<9
     #define UD_VALUETYPE 1<<10 // flag it's a valuetype, don't cache value by ptr
+    #define UD_INLINE 1<<11 // flag value stored in userdata memory, freed with userdata
 
     struct UDBase {
         uint32 flag;
@@ -197,6 +200,11 @@ namespace NS_SLUA {
         UObject* get() {
             return ud.Get();
         }
+
+        // null only if object is collected and its index may be reused
+        UObject* getEvenIfPendingKill() {
+            return ud.Get(true);
+        }
     };
 
     class SLUA_UNREAL_API LuaObject
@@ -365,6 +373,14 @@ namespace NS_SLUA {
         static void addOperator(lua_State* L, const char* name, lua_CFunction func);
         static void finishType(lua_State* L, const char* tn, lua_CFunction ctor, lua_CFunction gc, lua_CFunction strHint=nullptr);
 
+        // bind is called on first access of global tn or metatable of tn, not at init
+        typedef void (*LazyBindFunc)(lua_State* L);
+        static void regLazyType(lua_State* L, const char* tn, LazyBindFunc bind);
+        // return true if tn is lazy type and bound now
+        static bool bindLazyType(lua_State* L, const char* tn);
+        // same as luaL_getmetatable, but bind lazy type if needed
+        static int getMetatable(lua_State* L, const char* tn);
+
         // check UObject is valid
         static bool isUObjectValid(UObject* obj) {
 #if ENGINE_MAJOR_VERSION >= 5
@@ -669,7 +685,7 @@ namespace NS_SLUA {
 
         template<class T>
         static int push(lua_State* L, const char* fn, const T* v, uint32 flag = UD_NOFLAG) {
-            luaL_getmetatable(L,fn);
+            getMetatable(L,fn);
 
             // if v is the UnrealType
             UScriptStruct* uss = nullptr;
@@ -703,10 +719,27 @@ namespace NS_SLUA {
         static void linkProp(lua_State* L, void* parentAddress, void* prop);
         static void unlinkProp(lua_State* L, void* prop);
 
+        // push uninitialized value stored in userdata after UserData header, no heap object and no link,
+        // only for plain old data which no child property links to
+        template<class T>
+        static T* pushInline(lua_State* L, const char* tn) {
+            static_assert(std::is_trivially_destructible<T>::value, "Inline value type should be trivially destructible");
+            auto ud = lua_newuserdata(L, sizeof(UserData<T*>) + sizeof(T) + alignof(T) - 1);
+            if (!ud) luaL_error(L, "out of memory to new ud");
+            auto udptr = reinterpret_cast<UserData<T*>*>(ud);
+            T* v = reinterpret_cast<T*>(Align(reinterpret_cast<uint8*>(udptr + 1), alignof(T)));
+            udptr->parent = nullptr;
+            udptr->ud = v;
+            udptr->flag = UD_VALUETYPE | UD_INLINE;
+            getMetatable(L, tn);
+            lua_setmetatable(L, -2);
+            return v;
+        }
+
         template<class T>
         static int pushAndLink(lua_State* L, const void* parent, const char* tn, const T* v) {
             NewUD(T, v, UD_NOFLAG);
-            luaL_getmetatable(L, tn);
+            getMetatable(L, tn);
             lua_setmetatable(L, -2);
             linkProp(L, void_cast(parent), void_cast(udptr));
             return 1;
@@ -980,14 +1013,32 @@ namespace NS_SLUA {
         static FProperty* findCacheProperty(lua_State* L, UStruct* cls, const char* pname);
         static int fastIndex(lua_State* L, uint8* parent);
         static int fastNewIndex(lua_State* L, uint8* parent);
+        // get/set property of parent by key at index 2 through accessor table of cls,
+        // return 0/false if key isn't a property can be handled here
+        static int accessorIndex(lua_State* L, UStruct* cls, uint8* parent);
+        static bool accessorNewIndex(lua_State* L, UStruct* cls, uint8* parent);
+        static const struct LuaPropAccessor* findAccessor(lua_State* L, UStruct* cls, int keyIndex);
+        // LuaStruct owns initialized buffer of uss, from struct pool if possible
+        static LuaStruct* newStruct(lua_State* L, UScriptStruct* uss);
+        // cache accessor at lua field access sites, see lua_setinlinecache
+        static void setInlineCache(lua_State* L, bool enable);
+        // drop native object cache entry of userdata going to be finalized, see lua_setfnzhook
+        static void setObjectCache(lua_State* L, bool enable);
 
         static bool getObjCache(lua_State* L, void* obj, const char* tn);
         static void cacheObj(lua_State* L, void* obj);
+        // UObject use native object cache of state if enabled
+        static bool getObjCache(lua_State* L, UObject* obj, const char* tn);
+        static void cacheObj(lua_State* L, UObject* obj);
         static void removeObjCache(lua_State* L, void* obj);
 
         static bool getCache(lua_State* L, const void* obj, int ref);
         static void addCache(lua_State* L, const void* obj, int ref);
         static void removeCache(lua_State* L, const void* obj, int ref);
+        // drop flattened extension fields of deleted class
+        static void removeExtensionIndex(UClass* cls);
+        // drop extension field name cached in function cache of cls and its subclasses
+        static void removeExtensionCache(lua_State* L, UClass* cls, const char* name);
         
         static ULatentDelegate* getLatentDelegate(lua_State* L);
         
@@ -1001,6 +1052,7 @@ namespace NS_SLUA {
         static int gcClass(lua_State* L);
         static int gcStructClass(lua_State* L);
         static int gcStruct(lua_State* L);
+        static void objectCacheFnzHook(lua_State* L, void* u, lua_CFunction gc);
         static int objectToString(lua_State* L);
         static void setupMetaTable(lua_State* L,const char* tn,lua_CFunction setupmt,lua_CFunction gc);
         static void setupMetaTable(lua_State* L, const char* tn, lua_CFunction setupmt, int gc);
@@ -1009,6 +1061,35 @@ namespace NS_SLUA {
         static void createTable(lua_State* L, const char* tn);
     };
 
+    // property resolved once, get/set by offset without name lookup
+    struct LuaPropAccessor {
+        enum Flag {
+            ReadOnly = 1,
+            // pushed by reference pusher and cached in uservalue, use the old path
+            Reference = 1 << 1,
+        };
+        FProperty* prop;
+        // struct owns the accessor table
+        UStruct* owner;
+        int32 offset;
+        uint32 flags;
+        LuaObject::PushPropertyFunction pusher;
+        LuaObject::CheckPropertyFunction checker;
+        // generated by LuaStaticBinding for the property of a class, used before pusher and checker
+        int (*getter)(lua_State* L, UObject* obj);
+        void (*setter)(lua_State* L, UObject* obj, int valueIdx);
+    };
+
+    // accessors of one UStruct, in one array
+    struct LuaAccessorTable {
+        TArray<LuaPropAccessor> slots;
+        // interned lua short string -> slot, key anchored so its address isn't reused
+        TMap<const void*, int32> index;
+        // string not a property -> its hash, not anchored, so checked by hash in case address is reused,
+        // emptied when it reaches MaxAccessorMisses
+        TMap<const void*, uint32> misses;
+    };
+
     template<>
     inline UClass* LuaObject::checkValue(lua_State* L, int p) {
         CheckUD(UClass, L, p);
@@ -0,0 +1,63 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+#include "CoreMinimal.h"
+
+class UObjectBase;
+
+namespace NS_SLUA {
+
+    // userdata of pushed UObject of one lua_State, indexed by GUObjectArray index
+    // and tagged by serial number of the object, replace weak cache table in registry.
+    // entry must be removed before its userdata is finalized, see lua_setfnzhook
+    class SLUA_UNREAL_API LuaObjectCache {
+    public:
+        // entries per page, pages allocated on demand
+        static const int32 PageBits = 12;
+        static const int32 PageSize = 1 << PageBits;
+
+        struct Stats {
+            uint64 hits;
+            uint64 misses;
+            uint64 adds;
+            uint64 removes;
+            int32 live;
+            int32 maxLive;
+            int32 pages;
+        };
+
+        LuaObjectCache();
+        ~LuaObjectCache();
+
+        // used by new lua state only, existing state keep its cache
+        static bool isEnabled();
+
+        void* find(const UObjectBase* obj);
+        void add(const UObjectBase* obj, void* ud);
+        // remove entry of index, only if it's ud when ud isn't null
+        void remove(int32 index, void* ud = nullptr);
+
+        const Stats& getStats() const { return stats; }
+        void dumpStats() const;
+
+    private:
+        struct Entry {
+            int32 serial;
+            void* ud;
+        };
+
+        TArray<Entry*> pages;
+        Stats stats;
+    };
+}
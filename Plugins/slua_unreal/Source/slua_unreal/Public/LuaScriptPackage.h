@@ -0,0 +1,91 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+namespace NS_SLUA {
+
+    struct LuaFileSpan;
+
+    // packed lua scripts in one file, memory mapped once, module data served from mapped memory
+    // layout: Header, Entry[count] sorted by nameHash, names, data
+    class SLUA_UNREAL_API LuaScriptPackage {
+    public:
+        static const uint32 Magic = 0x4b504c53; // "SLPK"
+        static const uint32 Version = 2;
+
+        enum EntryFlag {
+            EntryBytecode = 1,
+        };
+
+        struct Header {
+            uint32 magic;
+            uint32 version;
+            uint32 count;
+            uint32 flags;
+        };
+
+        struct Entry {
+            uint64 nameHash;
+            uint32 nameOffset;
+            uint32 nameSize;
+            uint32 dataOffset;
+            uint32 dataSize;
+            uint32 flags;
+            uint32 reserved;
+        };
+
+        // pack all .lua files under dir to outFile, module name is relative path joined by '.'
+        // if compile, store bytecode instead of source
+        static bool build(const FString& dir, const FString& outFile, bool compile);
+
+        // mount package file, later mounted package is searched first
+        static bool mount(const FString& file);
+        // data returned by find is invalid after unmount, spans from loadFileSpan stay valid until released
+        static void unmountAll();
+        static bool isMounted();
+
+        // find module in mounted packages, data points to mapped memory
+        static bool find(const char* module, const uint8*& data, uint32& size, FString& filepath);
+
+        // can be used as LuaState::LoadFileDelegate directly
+        static TArray<uint8> loadFile(const char* fn, FString& filepath);
+        // can be used as LuaState::LoadFileSpanDelegate, no copy, span holds the package
+        static bool loadFileSpan(const char* fn, FString& filepath, LuaFileSpan& span);
+
+        static uint64 hashName(const char* name, uint32 len);
+
+        ~LuaScriptPackage();
+
+    private:
+        LuaScriptPackage();
+        bool open(const FString& file);
+        const Entry* findEntry(const char* module) const;
+        // package returned is held, data stays valid while it lives
+        static TSharedPtr<LuaScriptPackage, ESPMode::ThreadSafe> findPackage(const char* module, const uint8*& data, uint32& size, FString& filepath);
+
+        FString fileName;
+        IMappedFileHandle* mappedHandle;
+        IMappedFileRegion* mappedRegion;
+        // used if platform can't map file
+        TArray<uint8> fileData;
+        const uint8* base;
+        uint64 size;
+        const Header* header;
+        const Entry* entries;
+    };
+}
@@ -4,6 +4,7 @@
 #include "UObject/UnrealType.h"
 #include "UObject/GCObject.h"
 #include "PropertyUtil.h"
+#include "LuaArray.h"
 #include "lauxlib.h"
 
 namespace NS_SLUA {
@@ -73,6 +74,9 @@ namespace NS_SLUA {
         static int Pairs(lua_State* L);
         static int Enumerable(lua_State* L);
         static int CreateElementTypeObject(lua_State* L);
+        // copy all elements to a new lua table (1-based), or replace all elements by a table
+        static int ToTable(lua_State* L);
+        static int FromTable(lua_State* L);
 
     private:
         FScriptSet* Set;
@@ -81,19 +85,15 @@ namespace NS_SLUA {
 
         bool IsRef;
         bool isNewInner;
-
-        struct Enumerator
-        {
-            LuaSet* Set = nullptr;
-            int32 Index = 0;
-            int32 Num = 0;
-            static int gc(lua_State* L);
-        };
+        // resolved once from InElementProperty
+        LuaArray::ElementPusher ElementPusher;
+        LuaArray::ElementChecker ElementChecker;
 
         static int setupMT(lua_State* L);
         static int gc(lua_State* L);
 
         int32 num() const;
+        int pushElement(lua_State* L, uint8* ElementPtr);
         void clear();
         void emptyElements(int32 Slack = 0);
         void removeAt(int32 Index, int32 Count = 1);
@@ -24,6 +24,7 @@
 #endif
 #include "HAL/Runnable.h"
 #include "Tickable.h"
+#include "Async/Future.h"
 
 #define SLUA_LUACODE "[sluacode]"
 #define SLUA_CPPINST "__cppinst"
@@ -33,10 +34,20 @@ class ULatentDelegate;
 namespace NS_SLUA {
     DECLARE_MULTICAST_DELEGATE_OneParam(FLuaStateInitEvent, lua_State*);
 
-    struct ScriptTimeoutEvent {
-        virtual void onTimeout() = 0;
+    // long running script calls of one call site
+    struct ScriptCallSiteStats {
+        // calls longer than 1x, 2x, 4x, 8x, 16x of warn threshold
+        static const int NumBuckets = 5;
+        uint32 buckets[NumBuckets] = { 0 };
+        uint32 count = 0;
+        double totalMs = 0.0;
+        double maxMs = 0.0;
+        // where the script was when checker sampled it
+        FString lastSample;
     };
 
+    // watchdog of script calls, game thread publish outermost call to a seqlock slot,
+    // checker thread samples the slot, no hook installed until call runs too long
     class FDeadLoopCheck : public FRunnable
     {
     public:
@@ -45,30 +56,50 @@ namespace NS_SLUA {
 
         static int32 NameCounter;
 
-        int scriptEnter(ScriptTimeoutEvent* pEvent);
+        // site is the lua function called, used as key of call site stats
+        int scriptEnter(lua_State* L, const void* site);
         int scriptLeave();
 
+        // game thread only
+        const TMap<FString, ScriptCallSiteStats>& getCallSites() const { return callSites; }
+        void dumpCallSites() const;
+        void clearCallSites();
+
     protected:
         uint32 Run() override;
         void Stop() final;
-        void onScriptTimeout();
     private:
-        std::atomic<ScriptTimeoutEvent*> timeoutEvent;
-        FThreadSafeCounter timeoutCounter;
+        static void sampleHook(lua_State *L, lua_Debug *ar);
+        static void timeoutHook(lua_State *L, lua_Debug *ar);
+        double elapsedMs() const;
+
+        // published current call, seq is odd while game thread writing
+        std::atomic<uint32> seq;
+        std::atomic<lua_State*> currentL;
+        std::atomic<uint64> enterCycles;
+        // seq of call sampled by checker, only sample once per call
+        std::atomic<uint32> sampledSeq;
+
+        // game thread only
+        int depth;
+        const void* currentSite;
+        FString sampledLocation;
+        TMap<FString, ScriptCallSiteStats> callSites;
+
+        // held by checker while it touches lua_State, by destructor before state closed
+        FCriticalSection hookLock;
         FThreadSafeCounter stopCounter;
-        FThreadSafeCounter frameCounter;
         FRunnableThread* thread;
     };
 
     // check lua script dead loop
-    class LuaScriptCallGuard : public ScriptTimeoutEvent {
+    class LuaScriptCallGuard {
     public:
-        LuaScriptCallGuard(lua_State* L);
-        virtual ~LuaScriptCallGuard();
-        void onTimeout() override;
+        // funcIdx is stack index of function to call, 0 if unknown
+        LuaScriptCallGuard(lua_State* L, int funcIdx = 0);
+        ~LuaScriptCallGuard();
     private:
         lua_State* L;
-        static void scriptTimeout(lua_State *L, lua_Debug *ar);
     };
 
     typedef TSet<UObjectBase*> ObjectSet;
@@ -89,6 +120,28 @@ namespace NS_SLUA {
 
     typedef TMap<UObject*, GenericUserData*> UObjectRefMap;
 
+    // file content borrowed from loader, release is called when lua don't need data any more
+    struct SLUA_UNREAL_API LuaFileSpan {
+        const uint8* data = nullptr;
+        uint32 size = 0;
+        // null if data needn't release, e.g. mapped memory
+        void (*release)(void* ud) = nullptr;
+        void* ud = nullptr;
+
+        LuaFileSpan() {}
+        ~LuaFileSpan() { reset(); }
+        LuaFileSpan(const LuaFileSpan&) = delete;
+        LuaFileSpan& operator=(const LuaFileSpan&) = delete;
+
+        void reset() {
+            if (release) release(ud);
+            data = nullptr;
+            size = 0;
+            release = nullptr;
+            ud = nullptr;
+        }
+    };
+
     class SLUA_UNREAL_API LuaState 
         : public FUObjectArray::FUObjectDeleteListener
         , public FUObjectArray::FUObjectCreateListener
@@ -104,6 +157,11 @@ namespace NS_SLUA {
          * if find fn to load, return file size to len and file full path fo filepath arguments.
          */
         typedef TArray<uint8> (*LoadFileDelegate) (const char* fn, FString& filepath);
+        /*
+         * same as LoadFileDelegate, but fill span with borrowed buffer instead of copy to TArray
+         * return false if fn not found
+         */
+        typedef bool (*LoadFileSpanDelegate) (const char* fn, FString& filepath, LuaFileSpan& span);
         DECLARE_MULTICAST_DELEGATE_OneParam(ErrorDelegate, const char*);
 
         inline static LuaState* get(lua_State* l=nullptr) {
@@ -120,6 +178,9 @@ namespace NS_SLUA {
         // get LuaState from name
         static LuaState* get(const FString& name);
 
+        // extension field added to cls, drop it from function caches of all states
+        static void removeExtensionCache(UClass* cls, const char* name);
+
         static UGameInstance* getObjectGameInstance(const UObject* obj);
 
         UGameInstance* getGameInstance() const {
@@ -167,6 +228,36 @@ namespace NS_SLUA {
         // require a module
         LuaVar requireModule(const char* fn, LuaVar* pEnv = nullptr);
 
+        // compile modules on worker threads, later require of these modules only undump bytecode
+        // modules is a manifest of module names passed to require, see getRequiredModules
+        // load file delegate will be called on worker threads, it must be thread safe
+        void prefetchModules(const TArray<FString>& modules);
+        // modules required by this state in order, save it as prefetch manifest for next run
+        const TArray<FString>& getRequiredModules() const {
+            return requiredModules;
+        }
+
+        // snapshot of a prepared state, states created from it skip file io and compile.
+        // lua objects can't be shared between lua_States, so template keeps modules required
+        // in order and their bytecode, bytecode is immutable and shared by all states
+        struct Template {
+            struct Module {
+                FString name;
+                FString filepath;
+                // invalid if module isn't loaded from file, e.g. preload
+                TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> bytecode;
+            };
+            TArray<Module> modules;
+            TMap<FString, int32> moduleIndex;
+            LoadFileDelegate loadFileDelegate = nullptr;
+            LoadFileSpanDelegate loadFileSpanDelegate = nullptr;
+        };
+        typedef TSharedPtr<const Template, ESPMode::ThreadSafe> TemplatePtr;
+        // capture modules required by this state, template can be used by states on any thread
+        TemplatePtr makeTemplate() const;
+        // init, then require modules of template in the same order as template state did
+        bool initFromTemplate(TemplatePtr tmpl);
+
        
         // call function that specified by key
         // any supported c++ value can be passed as argument to lua 
@@ -183,6 +274,8 @@ namespace NS_SLUA {
 
         // set load delegation function to load lua code
         void setLoadFileDelegate(LoadFileDelegate func);
+        // span delegate is used first if set, LoadFileDelegate still work as fallback
+        void setLoadFileSpanDelegate(LoadFileSpanDelegate func);
         // get error delegation function to handle error
         ErrorDelegate* getErrorDelegate();
 
@@ -190,6 +283,25 @@ namespace NS_SLUA {
         {
             return L;
         }
+        // nullptr if script watchdog is off
+        FDeadLoopCheck* getDeadLoopCheck() const
+        {
+            return deadLoopCheck;
+        }
+        // size class allocator, null if lua_State use FMemory directly
+        class LuaAllocator* getAllocator() const
+        {
+            return allocator;
+        }
+        class LuaStructPool* getStructPool() const
+        {
+            return structPool;
+        }
+        // native cache of pushed UObject, null if weak cache table is used
+        class LuaObjectCache* getObjectCache() const
+        {
+            return objCache;
+        }
         operator lua_State*() const
         {
             return L;
@@ -205,6 +317,45 @@ namespace NS_SLUA {
         }
 
         void setGCParam(double limitSeconds, int limitCount, double interval);
+        // adaptive gc pacer, step gc every frame within frameBudget seconds and try to keep heap under targetHeapKB
+        // if frameTime > 0, pacer also shrink budget when the frame already cost too much
+        // frameBudget <= 0 to disable pacer and use setGCParam behavior
+        void setGCPacer(double frameBudget, int targetHeapKB, double frameTime = 0.0);
+
+        struct GCPacerStats {
+            uint64 frames = 0;
+            uint64 overBudgetFrames = 0;
+            uint64 steps = 0;
+            uint64 cycles = 0;
+            double budget = 0.0;
+            double lastCost = 0.0;
+            double maxCost = 0.0;
+            double avgCost = 0.0;
+            // bytes per second
+            double allocRate = 0.0;
+            int heapKB = 0;
+            int stepKB = 0;
+            int pause = 0;
+            int stepmul = 0;
+        };
+        const GCPacerStats& getGCPacerStats() const { return gcPacerStats; }
+
+        struct DeferGCStructStats {
+            uint64 gameThreadFreed = 0;
+            uint64 workerFreed = 0;
+            int32 backlog = 0;
+            int32 maxBacklog = 0;
+            // buffers not freed yet by worker thread
+            int32 workerPending = 0;
+        };
+        const DeferGCStructStats& getDeferGCStructStats() const { return deferGCStructStats; }
+
+        // cost of init, before onInitEvent broadcast
+        struct InitStats {
+            double seconds = 0.0;
+            int heapKB = 0;
+        };
+        const InitStats& getInitStats() const { return initStats; }
         void setTickFunction(LuaVar func);
 
         // add obj to ref, tell Engine don't collect this obj
@@ -242,6 +393,10 @@ namespace NS_SLUA {
 
         // call this function on script error
         void onError(const char* err);
+
+        // pop value on top of l to registry, slot reused from free list of released refs
+        int refValue(lua_State* l);
+        void unrefValue(int ref);
         
         static bool hookObject(LuaState* inState, const class UObjectBaseUtility* obj, bool bHookImmediate = true, bool bPostHook = false);
 
@@ -258,9 +413,24 @@ namespace NS_SLUA {
 
     protected:
         LoadFileDelegate loadFileDelegate;
+        LoadFileSpanDelegate loadFileSpanDelegate;
         ErrorDelegate errorDelegate;
         TArray<uint8> loadFile(const char* fn,FString& filepath);
+        // search mounted script package, then span delegate, then LoadFileDelegate through adapter
+        static bool loadFileSpan(LoadFileSpanDelegate spanDelegate, LoadFileDelegate delegate,
+            const char* fn, FString& filepath, LuaFileSpan& span);
         static int loader(lua_State* L);
+
+        struct PrefetchResult {
+            FString filepath;
+            TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> bytecode;
+        };
+        static PrefetchResult prefetchModule(LoadFileSpanDelegate spanDelegate, LoadFileDelegate delegate, const FString& module);
+        TMap<FString, TFuture<PrefetchResult>> prefetchMap;
+        TArray<FString> requiredModules;
+        // dedup of requiredModules, which keeps require order
+        TSet<FString> requiredModuleSet;
+        TemplatePtr stateTemplate;
         static int import(lua_State *L);
         static int getStringFromMD5(lua_State* L);
 
@@ -278,11 +448,19 @@ namespace NS_SLUA {
         friend class SluaUtil;
         friend struct LuaEnums;
         friend class LuaScriptCallGuard;
+        friend class FDeadLoopCheck;
         lua_State* L;
+        class LuaAllocator* allocator;
+        class LuaStructPool* structPool;
+        class LuaObjectCache* objCache;
         int cacheObjRef;
         int cacheEnumRef;
         int cacheClassPropRef;
         int cacheClassFuncRef;
+        // anchor of property names used as accessor keys, they can't be collected and reused
+        int accessorKeyRef;
+        // registry slots released by LuaVar, set to false
+        TArray<int> freeRefs;
         // init enums lua code
         LuaVar initInnerCode(const char* s);
         int _pushErrorHandler(lua_State* L);
@@ -309,9 +487,27 @@ namespace NS_SLUA {
             FProperty* findProp(UStruct* ustruct, const char* pname);
             void clear() {
                 cachePropMap.Empty();
+                accessorMap.Empty();
+                lastAccessorStruct = nullptr;
+                lastAccessorTable = nullptr;
+            }
+            // return true if accessor table of ustruct removed
+            bool remove(UStruct* ustruct) {
+                cachePropMap.Remove(ustruct);
+                if (accessorMap.Remove(ustruct)) {
+                    lastAccessorStruct = nullptr;
+                    lastAccessorTable = nullptr;
+                    return true;
+                }
+                return false;
             }
 
             CachePropMap cachePropMap;
+
+            // see LuaObject::findAccessor
+            TMap<UStruct*, LuaAccessorTable> accessorMap;
+            UStruct* lastAccessorStruct = nullptr;
+            LuaAccessorTable* lastAccessorTable = nullptr;
         } classMap;
 
         enum ImportedType {
@@ -344,6 +540,19 @@ namespace NS_SLUA {
         int stepGCCountLimit;
         double fullGCInterval;
         double lastFullGCSeconds;
+
+        void tickGCPacer(float dtime);
+        static void* countAlloc(void* ud, void* ptr, size_t osize, size_t nsize);
+        lua_Alloc innerAlloc;
+        void* innerAllocUD;
+        uint64 allocatedBytes;
+        uint64 lastAllocatedBytes;
+        double gcPacerBudget;
+        double gcPacerFrameTime;
+        int gcPacerTargetKB;
+        // measured step cost, seconds per KB
+        double gcPacerCostPerKB;
+        GCPacerStats gcPacerStats;
         
         LuaVar stateTickFunc;
 
@@ -362,6 +571,10 @@ namespace NS_SLUA {
         TArray<ObjectSet> newObjectsInCallStack;
 
         TArray<struct LuaStruct*> deferGCStruct;
+        DeferGCStructStats deferGCStructStats;
+        void tickDeferGCStruct();
+
+        InitStats initStats;
 
 #if UE_BUILD_DEVELOPMENT
         bool bRefTraceEnable;
@@ -0,0 +1,69 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+#include "LuaObject.h"
+
+namespace NS_SLUA {
+
+    // static lua_CFunction wrappers of UCLASS methods and properties, generated by
+    // slua.GenStaticBinding from reflection data, used by objectIndex in place of reflection
+    class SLUA_UNREAL_API LuaStaticBinding {
+    public:
+        // obj is instance of the class entry registered for
+        typedef int (*Getter)(lua_State* L, UObject* obj);
+        typedef void (*Setter)(lua_State* L, UObject* obj, int valueIdx);
+
+        // method if func isn't null, else property
+        struct Entry {
+            const char* name;
+            lua_CFunction func;
+            Getter getter;
+            Setter setter;
+        };
+
+        // register entries of class by name without prefix, entries must live until module unloaded
+        struct Registrar {
+            Registrar(const TCHAR* className, const Entry* entries, int32 count);
+        };
+
+        // entry of cls or its super, method is skipped if it's overridden or hooked by lua
+        static const Entry* find(UClass* cls, const char* name);
+        // slua.StaticBinding, checked by accessors that cached a getter or setter
+        static bool isEnabled();
+        static void remove(UClass* cls);
+        static void clear();
+
+        // write wrappers of public non-virtual methods and properties of classes to outFile,
+        // unsupported params are skipped with a comment
+        static bool generate(const TArray<FString>& classNames, const FString& outFile);
+
+        template<typename T>
+        static T* checkObject(lua_State* L, int p) {
+            UObject* obj = LuaObject::checkValue<UObject*>(L, p);
+            T* ret = Cast<T>(obj);
+            if (obj && !ret)
+                luaL_error(L, "arg %d expect %s, but got %s", p, TCHAR_TO_UTF8(*T::StaticClass()->GetName()),
+                    TCHAR_TO_UTF8(*obj->GetClass()->GetName()));
+            return ret;
+        }
+
+        template<typename T>
+        static T* checkSelf(lua_State* L) {
+            T* ret = checkObject<T>(L, 1);
+            if (!ret)
+                luaL_error(L, "arg 1 expect %s, but got nil", TCHAR_TO_UTF8(*T::StaticClass()->GetName()));
+            return ret;
+        }
+    };
+}
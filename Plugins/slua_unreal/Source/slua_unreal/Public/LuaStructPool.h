@@ -0,0 +1,64 @@
+// Tencent is pleased to support the open source community by making sluaunreal available.
+
+// Copyright (C) 2018 THL A29 Limited, a Tencent company. All rights reserved.
+// Licensed under the BSD 3-Clause License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+
+// https://opensource.org/licenses/BSD-3-Clause
+
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+#include "CoreMinimal.h"
+
+namespace NS_SLUA {
+
+    struct LuaStruct;
+
+    // recycle LuaStruct of one lua_State with its buffer, by size class of struct,
+    // buffer is stored in the same block right after LuaStruct.
+    // pooled LuaStruct keep registered as FGCObject, with uss cleared while idle
+    class SLUA_UNREAL_API LuaStructPool {
+    public:
+        static const int NumSizeClasses = 10;
+        // larger struct use FMemory buffer and isn't pooled
+        static const uint32 MaxPooledSize = 512;
+        static const uint32 BufferAlignment = 16;
+        // idle structs kept per size class, more are freed
+        static const int32 MaxFreePerClass = 256;
+
+        struct Stats {
+            uint64 hits;
+            uint64 misses;
+            // struct too large or pool disabled
+            uint64 bypass;
+            uint64 trimmed;
+            // pooled structs in use, and its high water
+            int32 live;
+            int32 maxLive;
+            int32 idle;
+            int32 maxIdle;
+        };
+
+        LuaStructPool();
+        ~LuaStructPool();
+
+        // new LuaStruct with initialized buffer of uss, nullptr if uss can't be pooled
+        LuaStruct* acquire(UScriptStruct* uss);
+        // destroy struct in buffer and recycle, or delete LuaStruct not from pool
+        void release(LuaStruct* ls);
+
+        const Stats& getStats() const { return stats; }
+        static uint32 sizeOfClass(int index);
+        void dumpStats() const;
+
+    private:
+        void destroy(LuaStruct* ls);
+
+        TArray<LuaStruct*> freeLists[NumSizeClasses];
+        Stats stats;
+    };
+}
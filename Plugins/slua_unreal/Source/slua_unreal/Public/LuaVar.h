@@ -233,12 +233,11 @@ namespace NS_SLUA {
                 Log::Error("State of lua function is invalid");
                 return LuaVar();
             }
-            auto fillParam = [&]
-            {
-                return pushArg(std::forward<ARGS>(args)...);
-            };
             auto L = getState();
-            int nret = docall(fillParam);
+            int nret = docall(L, [&]
+            {
+                return pushArg(L, std::forward<ARGS>(args)...);
+            });
             auto ret = LuaVar::wrapReturn(L, nret);
             lua_pop(L, nret);
             return ret;
@@ -297,6 +296,9 @@ namespace NS_SLUA {
 
         void alloc(int n);
 
+        // strings shorter than it are stored in lua_var
+        static const size_t InlineStrSize = 16;
+
         struct Ref {
             Ref():refCount(1) {}
             virtual ~Ref() {}
@@ -330,44 +332,44 @@ namespace NS_SLUA {
             size_t length;
         };
 
-        struct RefRef: public Ref {
-            RefRef(lua_State* l);
-            virtual ~RefRef();
-            bool isValid() {
-                return ref != LUA_NOREF;
-            }
-            void push(lua_State* l) {
-                lua_geti(l,LUA_REGISTRYINDEX,ref);
-            }
-            int ref;
-            int stateIndex;
-        };
-
         int stateIndex;
 
         typedef struct {
             union {
-                RefRef* ref;
+                // registry slot owned by this var, see LuaState::refValue
+                int ref;
                 lua_Integer i;
                 lua_Number d;
                 RefStr* s;
                 void* ptr;
                 bool b;
+                char str[InlineStrSize];
             };
             Type luatype;
+            // length of str + 1, 0 if string is in s
+            uint8 inlineLen;
         } lua_var;
 
+        // single value is stored in inlineVar, more values in vars,
+        // never point vars to inlineVar, UE containers move LuaVar by memmove
+        lua_var inlineVar;
         lua_var* vars;
         size_t numOfVar;
+
+        lua_var* getVars() {
+            return numOfVar==1 ? &inlineVar : vars;
+        }
+        const lua_var* getVars() const {
+            return numOfVar==1 ? &inlineVar : vars;
+        }
     
         template<class F,class ...ARGS>
-        int pushArg(F f,ARGS&& ...args) const {
-            auto L = getState();
+        int pushArg(lua_State* L,F&& f,ARGS&& ...args) const {
             LuaObject::push(L,f);
-            return 1+pushArg(std::forward<ARGS>(args)...);
+            return 1+pushArg(L,std::forward<ARGS>(args)...);
         }
 
-        int pushArg() const {
+        int pushArg(lua_State* L) const {
             return 0;
         }
 
@@ -382,15 +384,33 @@ namespace NS_SLUA {
         }
 
         int docall(const FillParamCallback& fillParam) const;
-        int pushArgByParms(FProperty* prop,uint8* parms);
+        // fillParam pushes args and returns count, inlined instead of wrapped by std::function
+        template<class F>
+        int docall(lua_State* L,F&& fillParam) const {
+            int errhandle = beginCall(L);
+            return endCall(L,errhandle,fillParam());
+        }
+        // push error handler and function, return index of error handler
+        int beginCall(lua_State* L) const;
+        // call function with argn args pushed after it, return count of results
+        int endCall(lua_State* L,int errhandle,int argn) const;
 
         void clone(const LuaVar& other);
         void move(LuaVar&& other);
         void varClone(lua_var& tv,const lua_var& ov) const;
+        void varFree(lua_var& v);
         void pushVar(lua_State* l,const lua_var& ov) const;
+        void setString(lua_var& v,const char* buf,size_t len);
+        void setRef(lua_var& v,lua_State* l,int p,Type t);
+        static const char* stringBuf(const lua_var& v) {
+            return v.inlineLen ? v.str : v.s->buf;
+        }
+        static size_t stringLen(const lua_var& v) {
+            return v.inlineLen ? v.inlineLen - 1 : v.s->length;
+        }
 
         static int safeOutput(lua_State* L);
-        static FSafeOutputDelegate safeOutputLambda;
+        static TFunctionRef<void()>* safeOutputFunc;
     };
 
     template<>
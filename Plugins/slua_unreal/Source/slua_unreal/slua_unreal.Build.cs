@@ -23,9 +23,15 @@ public class slua_unreal : ModuleRules
         bEnableExceptions = true;
         bEnforceIWYU = false;
         bEnableUndefinedIdentifierWarnings = false;
+        // lua and luasocket sources are compiled into this module (see Private/lua, Private/luasocket),
+        // their internal macros must not leak into other files of a unity blob
+#if UE_4_21_OR_LATER
+        bUseUnity = false;
+#else
+        bFasterWithoutUnity = true;
+#endif
 
         var externalSource = Path.Combine(ModuleDirectory, "../../External");
-        var externalLib = Path.Combine(ModuleDirectory, "../../Library");
 
         PublicIncludePaths.AddRange(
             new string[] {
@@ -35,42 +41,6 @@ public class slua_unreal : ModuleRules
 			}
             );
 
-        if (Target.Platform == UnrealTargetPlatform.IOS)
-        {
-            PublicAdditionalLibraries.Add(Path.Combine(externalLib, "iOS/liblua.a"));
-        }
-        else if (Target.Platform == UnrealTargetPlatform.Android)
-        {
-#if UE_4_24_OR_LATER
-            PublicAdditionalLibraries.Add(Path.Combine(externalLib, "Android/armeabi-v7a/liblua.a"));
-            PublicAdditionalLibraries.Add(Path.Combine(externalLib, "Android/armeabi-arm64/liblua.a"));
-            PublicAdditionalLibraries.Add(Path.Combine(externalLib, "Android/x86/liblua.a"));
-#else
-            PublicLibraryPaths.Add(Path.Combine(externalLib, "Android/armeabi-arm64"));
-            PublicLibraryPaths.Add(Path.Combine(externalLib, "Android/armeabi-v7a"));
-            PublicLibraryPaths.Add(Path.Combine(externalLib, "Android/x86"));
-            PublicAdditionalLibraries.Add("lua");
-#endif
-        }
-#if UE_5_00_OR_LATER
-        else if (Target.Platform == UnrealTargetPlatform.Win32 )
-        {
-            PublicAdditionalLibraries.Add(Path.Combine(externalLib, "Win32/lua.lib"));
-        }
-#endif
-        else if (Target.Platform == UnrealTargetPlatform.Win64)
-        {
-            PublicAdditionalLibraries.Add(Path.Combine(externalLib, "Win64/lua.lib"));
-        }
-        else if (Target.Platform == UnrealTargetPlatform.Mac)
-        {
-            PublicAdditionalLibraries.Add(Path.Combine(externalLib, "Mac/liblua.a"));
-        }
-        else if (Target.Platform == UnrealTargetPlatform.Linux)
-        {
-            PublicAdditionalLibraries.Add(Path.Combine(externalLib, "Linux/liblua.a"));
-        }
-
     PublicDependencyModuleNames.AddRange(
             new string[]
             {
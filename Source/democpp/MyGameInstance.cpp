@@ -5,6 +5,7 @@
 #include "HAL/PlatformFileManager.h"
 #include "GenericPlatform/GenericPlatformFile.h"
 #include "Misc/FileHelper.h"
+#include "LuaScriptPackage.h"
 
 
 // read file content
@@ -39,6 +40,12 @@ void UMyGameInstance::CreateLuaState()
 
 	CloseLuaState();
 	state = new NS_SLUA::LuaState("SLuaMainState", this);
+
+	// packed scripts built by slua.BuildScriptPackage Lua Lua.slpk, searched before loose files
+	FString package = FPaths::ProjectContentDir() / TEXT("Lua.slpk");
+	if (!NS_SLUA::LuaScriptPackage::isMounted() && FPaths::FileExists(package)) {
+		NS_SLUA::LuaScriptPackage::mount(package);
+	}
 	state->setLoadFileDelegate([](const char* fn, FString& filepath)->TArray<uint8> {
 
 		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
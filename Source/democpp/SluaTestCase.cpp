@@ -269,6 +269,28 @@ namespace NS_SLUA {
         int FuncWithStr(const FString& str) {
             return str.Len();
         }
+
+        // construct, copy and destroy LuaVar count times, call func too if doCall, return seconds
+        double LuaVarLoop(LuaVar func, int count, bool doCall) {
+            double start = FPlatformTime::Seconds();
+            for (int i = 0; i < count; i++) {
+                LuaVar n(i);
+                LuaVar s("hello world");
+                LuaVar f = func;
+                if (doCall) {
+                    LuaVar ret = f.call(n, s);
+                }
+            }
+            return FPlatformTime::Seconds() - start;
+        }
+
+        // call func with int and float count times, return seconds
+        double LuaVarCall(LuaVar func, int count) {
+            double start = FPlatformTime::Seconds();
+            for (int i = 0; i < count; i++)
+                func.call(i, 1.5f);
+            return FPlatformTime::Seconds() - start;
+        }
     };
 
     DefLuaClass(PerfTest)
@@ -276,6 +298,8 @@ namespace NS_SLUA {
         DefLuaMethod(ReturnInt,&PerfTest::ReturnInt)
         DefLuaMethod(ReturnIntWithInt,&PerfTest::ReturnIntWithInt)
         DefLuaMethod(FuncWithStr,&PerfTest::FuncWithStr)
+        DefLuaMethod(LuaVarLoop,&PerfTest::LuaVarLoop)
+        DefLuaMethod(LuaVarCall,&PerfTest::LuaVarCall)
     EndDef(PerfTest,&PerfTest::create)
 
 	enum TestEnum {
@@ -476,8 +500,20 @@ int USluaTestCase::FuncWithStr(FString str) {
     return str.Len();
 }
 
+FVector USluaTestCase::AddVector(FVector a, FVector b) {
+    return a + b;
+}
+
 void USluaTestCase::TestUnicastDelegate(FString str)
 {
     int32 retVal = OnTestGetCount.IsBound() ? OnTestGetCount.Execute(str) : -1;
     NS_SLUA::Log::Log("TestUnicastDelegate retVal=%d", retVal);
+}
+
+int32 USluaTestCase::TestUnicastDelegateLoop(FString str, int32 count)
+{
+    int32 sum = 0;
+    for (int32 i = 0; i < count && OnTestGetCount.IsBound(); i++)
+        sum += OnTestGetCount.Execute(str);
+    return sum;
 }
\ No newline at end of file
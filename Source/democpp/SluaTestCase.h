@@ -175,6 +175,9 @@ public:
     UFUNCTION(BlueprintCallable, Category="Lua|TestCase")
     int FuncWithStr(FString str);
 
+    UFUNCTION(BlueprintCallable, Category="Lua|TestCase")
+    FVector AddVector(FVector a, FVector b);
+
     const USluaTestCase* constRetFunc() { return nullptr; }
 
 	FORCEINLINE int inlineFunc() { return 1; }
@@ -190,6 +193,10 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Lua|TestCase")
     void TestUnicastDelegate(FString str);
 
+    // for performance test, execute OnTestGetCount count times like event dispatched every tick
+    UFUNCTION(BlueprintCallable, Category = "Lua|TestCase")
+    int32 TestUnicastDelegateLoop(FString str, int32 count);
+
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTestAAA, FString, str);
 	UPROPERTY(BlueprintAssignable)
 	FOnTestAAA OnTestAAA;
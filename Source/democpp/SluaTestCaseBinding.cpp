@@ -0,0 +1,50 @@
+// generated by slua.GenStaticBinding, don't edit
+
+#include "LuaStaticBinding.h"
+#include "SluaTestCase.h"
+
+namespace NS_SLUA {
+
+    namespace {
+        int USluaTestCase_EmptyFunc(lua_State* L) {
+            auto self = LuaStaticBinding::checkSelf<USluaTestCase>(L);
+            self->EmptyFunc();
+            return 0;
+        }
+
+        int USluaTestCase_ReturnInt(lua_State* L) {
+            auto self = LuaStaticBinding::checkSelf<USluaTestCase>(L);
+            return LuaObject::push(L, self->ReturnInt());
+        }
+
+        int USluaTestCase_ReturnIntWithInt(lua_State* L) {
+            auto self = LuaStaticBinding::checkSelf<USluaTestCase>(L);
+            auto a2 = LuaObject::checkValue<int32>(L, 2);
+            return LuaObject::push(L, self->ReturnIntWithInt(a2));
+        }
+
+        int USluaTestCase_FuncWithStr(lua_State* L) {
+            auto self = LuaStaticBinding::checkSelf<USluaTestCase>(L);
+            auto a2 = LuaObject::checkValue<FString>(L, 2);
+            return LuaObject::push(L, self->FuncWithStr(a2));
+        }
+
+        int USluaTestCase_Value_get(lua_State* L, UObject* obj) {
+            return LuaObject::push(L, static_cast<USluaTestCase*>(obj)->Value);
+        }
+
+        void USluaTestCase_Value_set(lua_State* L, UObject* obj, int valueIdx) {
+            static_cast<USluaTestCase*>(obj)->Value = LuaObject::checkValue<int32>(L, valueIdx);
+        }
+
+        const LuaStaticBinding::Entry USluaTestCaseEntries[] = {
+            { "EmptyFunc", USluaTestCase_EmptyFunc, nullptr, nullptr },
+            { "ReturnInt", USluaTestCase_ReturnInt, nullptr, nullptr },
+            { "ReturnIntWithInt", USluaTestCase_ReturnIntWithInt, nullptr, nullptr },
+            { "FuncWithStr", USluaTestCase_FuncWithStr, nullptr, nullptr },
+            { "Value", nullptr, USluaTestCase_Value_get, USluaTestCase_Value_set },
+        };
+        LuaStaticBinding::Registrar USluaTestCaseRegistrar(TEXT("SluaTestCase"), USluaTestCaseEntries, (int32)(sizeof(USluaTestCaseEntries) / sizeof(USluaTestCaseEntries[0])));
+
+    }
+}